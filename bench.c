@@ -0,0 +1,310 @@
+/*
+ * bench.c - Generator and Solver Benchmark Driver
+ * 
+ * Sweeps board size, path_ratio, wall_ratio and seeds across
+ * generate_puzzle, generate_unique_puzzle, puzzle_has_solution,
+ * puzzle_count_solutions (every engine), game_state_hint (the first,
+ * searching hint of a game and the cached ones that follow while it is
+ * played to the end), rate_difficulty (on each unique puzzle) and
+ * puzzle_pack_load (each configuration's boards written to a pack and
+ * read back), and prints one JSON document
+ * with p50/p99 latency, throughput and unique-yield per configuration.
+ * 
+ * Usage: ./zip_bench [seeds_per_config] [max_size]
+ * Built and run by `make bench`. Sizes above max_size (default 20) are
+ * skipped; unique generation at 30x30 costs seconds per seed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "difficulty.h"
+#include "engine.h"
+#include "generator.h"
+#include "generator_unique.h"
+#include "hint.h"
+#include "puzzle_pack.h"
+#include "solver.h"
+#include "solver_count.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * TIMING
+ * ============================================================================ */
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+typedef struct {
+    double *samples;    /* latency of each call, microseconds */
+    int count;
+    int hits;           /* calls that produced a usable result */
+} Series;
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+    if (count == 0) return 0.0;
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+/* ============================================================================
+ * JSON OUTPUT
+ * ============================================================================ */
+
+typedef struct {
+    int rows;
+    int cols;
+    float path_ratio;
+    float wall_ratio;
+} BenchConfig;
+
+static bool first_record = true;
+
+static void print_series(const char *op, const char *engine,
+                         const BenchConfig *config, Series *series,
+                         bool report_yield) {
+    qsort(series->samples, series->count, sizeof(double), compare_double);
+    
+    double total = 0.0;
+    for (int i = 0; i < series->count; i++) {
+        total += series->samples[i];
+    }
+    
+    printf("%s\n    {\"op\": \"%s\"", first_record ? "" : ",", op);
+    first_record = false;
+    
+    if (engine) {
+        printf(", \"engine\": \"%s\"", engine);
+    }
+    printf(", \"rows\": %d, \"cols\": %d, \"path_ratio\": %.2f, \"wall_ratio\": %.2f",
+           config->rows, config->cols, config->path_ratio, config->wall_ratio);
+    printf(", \"samples\": %d, \"p50_us\": %.1f, \"p99_us\": %.1f",
+           series->count,
+           percentile(series->samples, series->count, 0.50),
+           percentile(series->samples, series->count, 0.99));
+    printf(", \"throughput_per_s\": %.1f",
+           total > 0.0 ? series->count / (total / 1e6) : 0.0);
+    if (report_yield) {
+        printf(", \"unique_yield\": %.3f",
+               series->count ? (double)series->hits / series->count : 0.0);
+    }
+    printf("}");
+}
+
+/* ============================================================================
+ * SWEEP
+ * ============================================================================ */
+
+#define UNIQUE_MAX_ATTEMPTS 100
+
+/*
+ * puzzle_has_solution() runs an unpruned DFS that wanders through open
+ * space before committing to the next number; past 8x8 single seeds take
+ * seconds, so larger configurations skip it rather than stall the sweep.
+ */
+#define HAS_SOLUTION_MAX_CELLS 64
+
+static const struct {
+    const char *name;
+    SolverEngine engine;
+} count_engines[] = {
+    {"grid", SOLVER_ENGINE_GRID}
+};
+
+#define ENGINE_COUNT ((int)(sizeof(count_engines) / sizeof(count_engines[0])))
+
+#define SERIES_COUNT (7 + ENGINE_COUNT)
+
+/*
+ * Play board to the end on hints: the first call's latency goes to
+ * first, the mean of the cached calls after it to cached. Each board
+ * gets its own cache, since the next one may reuse this one's address.
+ */
+static void bench_hints(const Board *board, Series *first, Series *cached) {
+    GameState *game = game_state_create(board);
+    HintCache *hints = hint_cache_create();
+    if (!game || !hints) {
+        game_state_free(game);
+        hint_cache_free(hints);
+        return;
+    }
+    
+    char key;
+    double t0 = now_us();
+    bool more = game_state_hint(game, hints, &key);
+    first->samples[first->count++] = now_us() - t0;
+    first->hits += more;
+    
+    int calls = 0;
+    double total = 0.0;
+    while (more && movement_try_move(game, key)) {
+        t0 = now_us();
+        more = game_state_hint(game, hints, &key);
+        total += now_us() - t0;
+        calls++;
+    }
+    if (calls > 0) {
+        cached->samples[cached->count++] = total / calls;
+        cached->hits += game_state_check_win(game);
+    }
+    
+    hint_cache_free(hints);
+    game_state_free(game);
+}
+
+/* Load every puzzle of the pack at path into one reused Board */
+static void bench_pack_load(const char *path, Series *load) {
+    PuzzlePack *pack = puzzle_pack_open(path);
+    if (!pack) return;
+    
+    Board *view = puzzle_pack_board_create(pack);
+    for (int i = 0; view && i < puzzle_pack_count(pack); i++) {
+        double t0 = now_us();
+        load->hits += puzzle_pack_load(pack, i, view);
+        load->samples[load->count++] = now_us() - t0;
+    }
+    
+    board_free(view);
+    puzzle_pack_close(pack);
+}
+
+static void bench_config(const BenchConfig *config, int seeds, double *scratch,
+                         const char *pack_path) {
+    Series generate = {scratch, 0, 0};
+    Series unique = {scratch + seeds, 0, 0};
+    Series has = {scratch + 2 * seeds, 0, 0};
+    Series hint_first = {scratch + 3 * seeds, 0, 0};
+    Series hint_cached = {scratch + 4 * seeds, 0, 0};
+    Series pack_load = {scratch + 5 * seeds, 0, 0};
+    Series rate = {scratch + 6 * seeds, 0, 0};
+    Series count[ENGINE_COUNT];
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        count[e] = (Series){scratch + (7 + e) * seeds, 0, 0};
+    }
+    PackWriter *pack = pack_writer_open(pack_path);
+    
+    for (int seed = 0; seed < seeds; seed++) {
+        double t0 = now_us();
+        Board *board = generate_puzzle(config->rows, config->cols,
+                                       config->path_ratio, config->wall_ratio,
+                                       (unsigned int)seed);
+        generate.samples[generate.count++] = now_us() - t0;
+        
+        if (board) {
+            generate.hits++;
+            pack_writer_add(pack, board, NULL, 0);
+            
+            if (config->rows * config->cols <= HAS_SOLUTION_MAX_CELLS) {
+                t0 = now_us();
+                has.hits += puzzle_has_solution(board);
+                has.samples[has.count++] = now_us() - t0;
+            }
+            
+            for (int e = 0; e < ENGINE_COUNT; e++) {
+                SolverOptions options = {count_engines[e].engine, false, 1, false, 0};
+                t0 = now_us();
+                count[e].hits += puzzle_count_solutions_ex(board, 2, &options, NULL) == 1;
+                count[e].samples[count[e].count++] = now_us() - t0;
+            }
+            
+            board_free(board);
+        }
+        
+        t0 = now_us();
+        board = generate_unique_puzzle(config->rows, config->cols,
+                                       config->path_ratio, config->wall_ratio,
+                                       (unsigned int)seed, UNIQUE_MAX_ATTEMPTS);
+        unique.samples[unique.count++] = now_us() - t0;
+        if (board) {
+            unique.hits++;
+            bench_hints(board, &hint_first, &hint_cached);
+            
+            DifficultyRating rating;
+            t0 = now_us();
+            rate.hits += rate_difficulty(board, &rating);
+            rate.samples[rate.count++] = now_us() - t0;
+            board_free(board);
+        }
+    }
+    
+    if (pack_writer_close(pack)) {
+        bench_pack_load(pack_path, &pack_load);
+    }
+    
+    print_series("generate_puzzle", NULL, config, &generate, false);
+    print_series("generate_unique_puzzle", NULL, config, &unique, true);
+    if (has.count > 0) {
+        print_series("puzzle_has_solution", NULL, config, &has, false);
+    }
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        print_series("puzzle_count_solutions", count_engines[e].name,
+                     config, &count[e], true);
+    }
+    if (hint_first.count > 0) {
+        print_series("game_state_hint", "first", config, &hint_first, false);
+    }
+    if (hint_cached.count > 0) {
+        print_series("game_state_hint", "cached", config, &hint_cached, false);
+    }
+    if (rate.count > 0) {
+        print_series("rate_difficulty", NULL, config, &rate, false);
+    }
+    if (pack_load.count > 0) {
+        print_series("puzzle_pack_load", NULL, config, &pack_load, false);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    int seeds = argc > 1 ? atoi(argv[1]) : 50;
+    int max_size = argc > 2 ? atoi(argv[2]) : 20;
+    if (seeds <= 0) seeds = 50;
+    
+    static const int sizes[] = {8, 10, 15, 20, 30, 40};
+    static const float path_ratios[] = {0.3f, 0.5f, 0.8f};
+    static const float wall_ratios[] = {0.1f, 0.3f, 0.6f};
+    
+    double *scratch = (double *)malloc((size_t)SERIES_COUNT * seeds * sizeof(double));
+    if (!scratch) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    
+    char pack_path[] = "/tmp/zip_bench_XXXXXX";
+    int pack_fd = mkstemp(pack_path);
+    if (pack_fd < 0) {
+        fprintf(stderr, "Cannot create %s\n", pack_path);
+        free(scratch);
+        return 1;
+    }
+    close(pack_fd);
+    
+    printf("{\n  \"seeds_per_config\": %d,\n  \"results\": [", seeds);
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        if (sizes[s] > max_size) continue;
+        for (size_t p = 0; p < sizeof(path_ratios) / sizeof(path_ratios[0]); p++) {
+            for (size_t w = 0; w < sizeof(wall_ratios) / sizeof(wall_ratios[0]); w++) {
+                BenchConfig config = {sizes[s], sizes[s], path_ratios[p], wall_ratios[w]};
+                bench_config(&config, seeds, scratch, pack_path);
+            }
+        }
+    }
+    
+    printf("\n  ]\n}\n");
+    
+    unlink(pack_path);
+    free(scratch);
+    return 0;
+}
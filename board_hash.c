@@ -0,0 +1,174 @@
+/*
+ * board_hash.c - Canonical Board Fingerprints Implementation
+ */
+
+#include "board_hash.h"
+#include <stdlib.h>
+
+/* ============================================================================
+ * FINGERPRINT
+ * ============================================================================ */
+
+/* splitmix64 finalizer: a bijection that spreads every input bit */
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+#define LANE_HI_SEED 0x243F6A8885A308D3ull
+#define LANE_LO_SEED 0x13198A2E03707344ull
+
+/* Cell code in one numbering direction: 0 empty, 1 wall, 2 + number */
+static uint64_t cell_code(const Cell *cell, int max_number, bool reversed) {
+    switch (cell->type) {
+        case CELL_EMPTY: return 0;
+        case CELL_WALL: return 1;
+        default:
+            return 2 + (uint64_t)(reversed ? max_number + 1 - cell->number
+                                           : cell->number);
+    }
+}
+
+static bool fingerprint_less(BoardFingerprint a, BoardFingerprint b) {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+/*
+ * Symmetry t maps (row, col) by transposing when t & 4, then flipping
+ * rows when t & 1 and columns when t & 2. Each variant hashes as a sum
+ * of per-cell mixes of (position in the variant, code), in two lanes;
+ * the sum does not depend on visiting order, so one row-major walk of
+ * the source board serves every variant.
+ */
+BoardFingerprint board_fingerprint(const Board *board) {
+    BoardFingerprint best = {UINT64_MAX, UINT64_MAX};
+
+    for (int t = 0; t < 8; t++) {
+        bool transpose = t & 4;
+        int height = transpose ? board->width : board->height;
+        int width = transpose ? board->height : board->width;
+        uint64_t lanes[2][2] = {{0, 0}, {0, 0}};   /* [reversed][hi, lo] */
+
+        for (int i = 0; i < board->height; i++) {
+            for (int j = 0; j < board->width; j++) {
+                int row = transpose ? j : i;
+                int col = transpose ? i : j;
+                if (t & 1) row = height - 1 - row;
+                if (t & 2) col = width - 1 - col;
+
+                const Cell *cell = board_cell(board, i, j);
+                uint64_t pos = (uint64_t)(row * width + col) << 32;
+                for (int r = 0; r < 2; r++) {
+                    uint64_t v = pos | cell_code(cell, board->max_number, r);
+                    lanes[r][0] += mix64(v ^ LANE_HI_SEED);
+                    lanes[r][1] += mix64(v ^ LANE_LO_SEED);
+                }
+            }
+        }
+
+        uint64_t shape = (uint64_t)height << 40 | (uint64_t)width << 16 |
+                         (uint64_t)board->rules;
+        for (int r = 0; r < 2; r++) {
+            BoardFingerprint fp = {
+                mix64(lanes[r][0] ^ mix64(shape ^ LANE_HI_SEED)),
+                mix64(lanes[r][1] ^ mix64(shape ^ LANE_LO_SEED)) | 1
+            };
+            if (fingerprint_less(fp, best)) best = fp;
+        }
+    }
+
+    return best;
+}
+
+/* ============================================================================
+ * FINGERPRINT SET
+ * ============================================================================ */
+
+struct FingerprintSet {
+    BoardFingerprint *slots;    /* all-zero marks an empty slot */
+    size_t mask;                /* slot count - 1, a power of two */
+    size_t size;
+};
+
+#define SET_MIN_SLOTS 64
+
+static bool slot_empty(BoardFingerprint fp) {
+    return fp.hi == 0 && fp.lo == 0;
+}
+
+/* Slot holding fp, or the empty slot where it would go */
+static size_t set_find(const FingerprintSet *set, BoardFingerprint fp) {
+    size_t i = (size_t)fp.hi & set->mask;
+    while (!slot_empty(set->slots[i]) && !board_fingerprint_equal(set->slots[i], fp)) {
+        i = (i + 1) & set->mask;
+    }
+    return i;
+}
+
+static bool set_alloc(FingerprintSet *set, size_t slot_count) {
+    set->slots = (BoardFingerprint *)calloc(slot_count, sizeof(BoardFingerprint));
+    set->mask = slot_count - 1;
+    return set->slots != NULL;
+}
+
+FingerprintSet *fingerprint_set_create(size_t expected) {
+    FingerprintSet *set = (FingerprintSet *)malloc(sizeof(FingerprintSet));
+    if (!set) return NULL;
+
+    /* Keep the load factor at or below one half */
+    size_t slot_count = SET_MIN_SLOTS;
+    while (slot_count < 2 * expected) slot_count *= 2;
+
+    set->size = 0;
+    if (!set_alloc(set, slot_count)) {
+        free(set);
+        return NULL;
+    }
+    return set;
+}
+
+void fingerprint_set_free(FingerprintSet *set) {
+    if (!set) return;
+    free(set->slots);
+    free(set);
+}
+
+static bool set_grow(FingerprintSet *set) {
+    FingerprintSet grown;
+    if (!set_alloc(&grown, 2 * (set->mask + 1))) return false;
+
+    for (size_t i = 0; i <= set->mask; i++) {
+        if (!slot_empty(set->slots[i])) {
+            grown.slots[set_find(&grown, set->slots[i])] = set->slots[i];
+        }
+    }
+    free(set->slots);
+    set->slots = grown.slots;
+    set->mask = grown.mask;
+    return true;
+}
+
+int fingerprint_set_insert(FingerprintSet *set, BoardFingerprint fp) {
+    size_t i = set_find(set, fp);
+    if (!slot_empty(set->slots[i])) return 0;
+
+    if (2 * (set->size + 1) > set->mask + 1) {
+        if (!set_grow(set)) return -1;
+        i = set_find(set, fp);
+    }
+    set->slots[i] = fp;
+    set->size++;
+    return 1;
+}
+
+bool fingerprint_set_contains(const FingerprintSet *set, BoardFingerprint fp) {
+    return !slot_empty(set->slots[set_find(set, fp)]);
+}
+
+size_t fingerprint_set_size(const FingerprintSet *set) {
+    return set->size;
+}
@@ -0,0 +1,64 @@
+/*
+ * board_hash.h - Canonical Board Fingerprints
+ *
+ * Rotating or reflecting a board, or walking its path backwards
+ * (renumbering k as max_number + 1 - k), gives the same puzzle. A board's
+ * fingerprint is the smallest 128-bit hash over all 16 such variants, so
+ * equivalent boards share it and everything else practically never does.
+ *
+ * A FingerprintSet remembers fingerprints in an open-addressing table,
+ * which makes "seen this puzzle before?" O(1) per candidate however large
+ * the corpus grows.
+ *
+ * Usage:
+ *   FingerprintSet *seen = fingerprint_set_create(0);
+ *   if (fingerprint_set_insert(seen, board_fingerprint(board)) == 1) {
+ *       ... first time this puzzle (or any variant) shows up ...
+ *   }
+ *   fingerprint_set_free(seen);
+ */
+
+#ifndef BOARD_HASH_H
+#define BOARD_HASH_H
+
+#include "engine.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Never all zero */
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} BoardFingerprint;
+
+/*
+ * Canonical fingerprint of board: cell types, numbers, dimensions and
+ * rules, minimized over the 8 dihedral symmetries and path reversal.
+ * Costs 8 passes over the cells.
+ */
+BoardFingerprint board_fingerprint(const Board *board);
+
+static inline bool board_fingerprint_equal(BoardFingerprint a, BoardFingerprint b) {
+    return a.hi == b.hi && a.lo == b.lo;
+}
+
+typedef struct FingerprintSet FingerprintSet;
+
+/* expected: fingerprints to size for up front (0 = small, grows anyway) */
+FingerprintSet *fingerprint_set_create(size_t expected);
+void fingerprint_set_free(FingerprintSet *set);
+
+/*
+ * Add fp
+ *
+ * Returns:
+ *   1  - fp was new and is now in the set
+ *   0  - fp was already there
+ *   -1 - allocation failure while growing (fp not added)
+ */
+int fingerprint_set_insert(FingerprintSet *set, BoardFingerprint fp);
+
+bool fingerprint_set_contains(const FingerprintSet *set, BoardFingerprint fp);
+size_t fingerprint_set_size(const FingerprintSet *set);
+
+#endif /* BOARD_HASH_H */
@@ -0,0 +1,269 @@
+/*
+ * difficulty.c - Difficulty Rating and Targeted Generation Implementation
+ *
+ * The deductions are the counter's pruning rules (solver_internal.h), so
+ * they never strike out the right move: at every step of the solution at
+ * least that move survives.
+ */
+
+#include "difficulty.h"
+#include "generator_clues.h"
+#include "solver_count.h"
+#include "solver_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * RATING STATE
+ * ============================================================================ */
+
+typedef struct {
+    const Board *board;
+    bool *visited;
+    int *trail;         /* cells entered while trying a wrong move */
+    SolverReach reach;
+    bool coverage;
+    int open_cells;
+} Rater;
+
+static void rater_free(Rater *r) {
+    free(r->visited);
+    free(r->trail);
+    free(r->reach.queue);
+    free(r->reach.seen);
+}
+
+static bool rater_init(Rater *r, const Board *board) {
+    int cells = board_cell_count(board);
+
+    r->board = board;
+    r->reach.generation = 0;
+    r->coverage = board->rules == RULES_FULL_COVERAGE;
+    r->open_cells = board_count_open_cells(board);
+    r->visited = (bool *)calloc(cells, sizeof(bool));
+    r->trail = (int *)malloc(cells * sizeof(int));
+    r->reach.queue = (int *)malloc(cells * sizeof(int));
+    r->reach.seen = (unsigned *)calloc(cells, sizeof(unsigned));
+    if (!r->visited || !r->trail || !r->reach.queue || !r->reach.seen) {
+        rater_free(r);
+        return false;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * DEDUCTIONS
+ * ============================================================================ */
+
+/*
+ * solver_head_reaches() with nothing forbidden: left is the numbers from
+ * next_number on (under full coverage: the open cells off the
+ * path_length-cell path)
+ */
+static bool rater_reaches(Rater *r, int head, int target, int next_number,
+                          int path_length) {
+    int left = r->coverage ? r->open_cells - path_length
+                           : r->board->max_number - next_number + 1;
+    return solver_head_reaches(&r->reach, r->board, r->visited, r->coverage,
+                               head, target, -1, left);
+}
+
+/* Full coverage: a cell needs a way in and out, the last number only one */
+static bool rater_cell_ok(const Rater *r, int cell, int head) {
+    const Board *board = r->board;
+    if (board->cells[cell].type == CELL_WALL || r->visited[cell]) return true;
+
+    int need = cell == board_number_index(board, board->max_number) ? 1 : 2;
+    return solver_free_neighbors(board, r->visited, cell, head) >= need;
+}
+
+/*
+ * True when stepping from prev onto cell (already marked visited, the
+ * path now path_length cells long, heading for next_number) is not
+ * plainly hopeless
+ */
+static bool rater_step_survives(Rater *r, int prev, int cell, int next_number,
+                                int path_length) {
+    const Board *board = r->board;
+
+    if (next_number > board->max_number) {
+        return !r->coverage || path_length == r->open_cells;
+    }
+    if (!rater_reaches(r, cell, board_number_index(board, next_number),
+                       next_number, path_length)) {
+        return false;
+    }
+    if (r->coverage) {
+        for (unsigned moves = board->open_dirs[prev]; moves; moves &= moves - 1) {
+            if (!rater_cell_ok(r, prev + board->delta[__builtin_ctz(moves)], cell)) {
+                return false;
+            }
+        }
+    }
+    return rater_reaches(r, cell, -1, next_number, path_length);
+}
+
+/* Number the path heads for after entering cell while heading for n */
+static int number_after(const Board *board, int cell, int n) {
+    return board->cells[cell].type == CELL_NUMBER ? n + 1 : n;
+}
+
+/*
+ * Moves from head that survive the deductions; fills out (up to 4
+ * cells) and returns how many
+ */
+static int rater_moves(Rater *r, int head, int next_number, int path_length,
+                       int out[4]) {
+    const Board *board = r->board;
+    int count = 0;
+
+    /* Under full coverage the path ends on the last number */
+    if (next_number > board->max_number) return 0;
+
+    for (unsigned moves = board->open_dirs[head]; moves; moves &= moves - 1) {
+        int cell = head + board->delta[__builtin_ctz(moves)];
+        const Cell *c = &board->cells[cell];
+        if (r->visited[cell]) continue;
+        if (c->type == CELL_NUMBER && c->number != next_number) continue;
+
+        r->visited[cell] = true;
+        if (rater_step_survives(r, head, cell, number_after(board, cell, next_number),
+                                path_length + 1)) {
+            out[count++] = cell;
+        }
+        r->visited[cell] = false;
+    }
+    return count;
+}
+
+/*
+ * Try the wrong move head -> cell: true when following forced moves
+ * from it hits a dead end within RATING_LOOKAHEAD steps
+ */
+static bool rater_refutes(Rater *r, int cell, int next_number, int path_length) {
+    const Board *board = r->board;
+    int trail_length = 0;
+    bool refuted = false;
+
+    r->visited[cell] = true;
+    r->trail[trail_length++] = cell;
+    int head = cell;
+    int n = number_after(board, cell, next_number);
+    int length = path_length + 1;
+
+    for (int step = 0; step < RATING_LOOKAHEAD; step++) {
+        if (n > board->max_number) break;    /* a second solution */
+
+        int moves[4];
+        int count = rater_moves(r, head, n, length, moves);
+        if (count == 0) {
+            refuted = true;
+            break;
+        }
+        if (count > 1) break;
+
+        head = moves[0];
+        r->visited[head] = true;
+        r->trail[trail_length++] = head;
+        n = number_after(board, head, n);
+        length++;
+    }
+
+    for (int i = 0; i < trail_length; i++) {
+        r->visited[r->trail[i]] = false;
+    }
+    return refuted;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+bool rate_difficulty(const Board *board, DifficultyRating *rating) {
+    if (!rating) return false;
+    memset(rating, 0, sizeof(*rating));
+    if (!board || !board->cells) return false;
+
+    int *solution = (int *)malloc(board_cell_count(board) * sizeof(int));
+    if (!solution) return false;
+
+    int length = 0;
+    Rater r;
+    if (puzzle_count_solutions_witness(board, 1, solution, &length, NULL) == 0 ||
+        !rater_init(&r, board)) {
+        free(solution);
+        return false;
+    }
+
+    int next_number = 2;
+    r.visited[solution[0]] = true;
+
+    for (int i = 0; i + 1 < length; i++) {
+        int head = solution[i];
+        int right = solution[i + 1];
+        int moves[4];
+        int count = rater_moves(&r, head, next_number, i + 1, moves);
+
+        if (count <= 1) {
+            rating->forced++;
+        } else {
+            rating->decisions++;
+            for (int k = 0; k < count; k++) {
+                if (moves[k] == right) continue;
+                if (rater_refutes(&r, moves[k], next_number, i + 1)) {
+                    rating->shallow++;
+                } else {
+                    rating->deep++;
+                }
+            }
+        }
+
+        r.visited[right] = true;
+        next_number = number_after(board, right, next_number);
+    }
+
+    rating->moves = length - 1;
+    if (rating->moves > 0) {
+        rating->score = 100.0 * (rating->shallow + RATING_DEEP_WEIGHT * rating->deep) /
+                        rating->moves;
+    }
+
+    rater_free(&r);
+    free(solution);
+    return true;
+}
+
+Board *generate_rated_puzzle(
+    const GeneratorParams *params,
+    unsigned int seed,
+    int target_clues,
+    double min_score,
+    double max_score,
+    int max_candidates,
+    DifficultyRating *rating
+) {
+    if (!params || min_score > max_score || max_candidates < 0 || target_clues < 0) {
+        return NULL;
+    }
+
+    for (int k = 0; max_candidates == 0 || k < max_candidates; k++) {
+        unsigned int candidate_seed = generate_batch_seed(seed, k);
+        Board *board = target_clues > 0 ?
+            generate_sparse_puzzle(params->rows, params->cols, params->path_ratio,
+                                   params->wall_ratio, candidate_seed,
+                                   params->max_attempts, target_clues) :
+            generate_unique_puzzle(params->rows, params->cols, params->path_ratio,
+                                   params->wall_ratio, candidate_seed,
+                                   params->max_attempts);
+        if (!board) continue;
+
+        DifficultyRating r;
+        if (rate_difficulty(board, &r) && r.score >= min_score && r.score <= max_score) {
+            if (rating) *rating = r;
+            return board;
+        }
+        board_free(board);
+    }
+
+    return NULL;
+}
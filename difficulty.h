@@ -0,0 +1,83 @@
+/*
+ * difficulty.h - Difficulty Rating and Targeted Generation
+ *
+ * Rates a puzzle the way a person solves it: walk the solution from
+ * number 1 and, at every step, strike out the moves that plainly fail
+ * (the next number or some later cell is cut off, or a cell is left a
+ * dead end). A step with one move left is forced. Otherwise it is a
+ * decision, and each wrong move still standing has to be refuted by
+ * trying it: following its forced moves either runs into a dead end
+ * within RATING_LOOKAHEAD steps (a shallow refutation) or does not (a
+ * deep one, which takes real guessing).
+ *
+ * Usage:
+ *   DifficultyRating rating;
+ *   if (rate_difficulty(board, &rating) && rating.score > 20.0) ...
+ */
+
+#ifndef DIFFICULTY_H
+#define DIFFICULTY_H
+
+#include "engine.h"
+#include "generator_unique.h"
+
+/* Forced moves followed when trying a wrong move before giving up */
+#define RATING_LOOKAHEAD 16
+
+/* Weight of a deep refutation relative to a shallow one in score */
+#define RATING_DEEP_WEIGHT 3
+
+typedef struct {
+    int moves;      /* steps in the solution */
+    int forced;     /* steps with a single surviving move */
+    int decisions;  /* steps with several */
+    int shallow;    /* wrong moves refuted by following forced moves */
+    int deep;       /* wrong moves that needed more than that */
+    double score;   /* 100 * (shallow + RATING_DEEP_WEIGHT * deep) / moves */
+} DifficultyRating;
+
+/*
+ * Rate a puzzle with a unique solution
+ *
+ * Returns false (rating zeroed) when the board has no solution or on
+ * allocation failure. On a board with several solutions the rating
+ * follows the first one found, and the other solutions' first moves
+ * count as deep refutations.
+ *
+ * Performance:
+ *   One pruned solve plus a few reachability passes per step; 10x10
+ *   boards rate in well under a millisecond (`make bench`)
+ */
+bool rate_difficulty(const Board *board, DifficultyRating *rating);
+
+/*
+ * Generate unique puzzles until one scores within [min_score, max_score]
+ *
+ * Parameters:
+ *   params         - Board shape and generation parameters; max_attempts
+ *                    applies to each candidate
+ *   seed           - Candidate k uses generate_batch_seed(seed, k)
+ *   target_clues   - Clues to thin each candidate down to
+ *                    (generate_sparse_puzzle()); 0 keeps every number,
+ *                    and such puzzles are all forced moves (score 0)
+ *   min_score,
+ *   max_score      - Difficulty band (DifficultyRating.score)
+ *   max_candidates - Candidates to generate before giving up
+ *                    (0 = unlimited, which never returns when the band
+ *                    is out of reach)
+ *   rating         - Receives the returned puzzle's rating (may be NULL)
+ *
+ * Returns:
+ *   Puzzle in the band (caller frees), or NULL when none turned up
+ */
+Board *generate_rated_puzzle(
+    const GeneratorParams *params,
+    unsigned int seed,
+    int target_clues,
+    double min_score,
+    double max_score,
+    int max_candidates,
+    DifficultyRating *rating
+);
+
+#endif /* DIFFICULTY_H */
@@ -12,61 +12,132 @@ Board *board_create(int height, int width) {
     Board *board = (Board *)malloc(sizeof(Board));
     if (!board) return NULL;
     
-    board->height = height;
-    board->width = width;
-    board->max_number = 0;
-    board->grid = (Cell **)malloc(height * sizeof(Cell *));
-    if (!board->grid) {
+    board->capacity = (height + 2 * BOARD_PADDING) * (width + 2 * BOARD_PADDING);
+    board->cells = (Cell *)malloc(board->capacity * sizeof(Cell));
+    board->open_dirs = (unsigned char *)malloc(board->capacity);
+    board->number_cells = (int *)malloc((board->capacity + 1) * sizeof(int));
+    if (!board->cells || !board->open_dirs || !board->number_cells) {
+        free(board->cells);
+        free(board->open_dirs);
+        free(board->number_cells);
         free(board);
         return NULL;
     }
     
-    for (int i = 0; i < height; i++) {
-        board->grid[i] = (Cell *)calloc(width, sizeof(Cell));
-        if (!board->grid[i]) {
-            for (int j = 0; j < i; j++) free(board->grid[j]);
-            free(board->grid);
-            free(board);
-            return NULL;
-        }
+    board_reset(board, height, width);
+    return board;
+}
+
+bool board_reset(Board *board, int height, int width) {
+    if ((height + 2 * BOARD_PADDING) * (width + 2 * BOARD_PADDING) > board->capacity) {
+        return false;
+    }
+    
+    board->height = height;
+    board->width = width;
+    board->max_number = 0;
+    board->stride = width + 2 * BOARD_PADDING;
+    board->rules = RULES_REACH_LAST;
+    board->delta[BOARD_UP] = -board->stride;
+    board->delta[BOARD_DOWN] = board->stride;
+    board->delta[BOARD_LEFT] = -1;
+    board->delta[BOARD_RIGHT] = 1;
+    memset(board->open_dirs, 0, board_cell_count(board));
+    memset(board->number_cells, 0, (board_cell_count(board) + 1) * sizeof(int));
+    
+    /* Everything starts as a wall so the padding ring blocks movement */
+    for (int i = 0; i < board_cell_count(board); i++) {
+        board->cells[i].type = CELL_WALL;
+        board->cells[i].number = 0;
     }
     
+    /* Every neighbor of an inner cell is open except the padding */
     for (int i = 0; i < height; i++) {
         for (int j = 0; j < width; j++) {
-            board->grid[i][j].type = CELL_EMPTY;
-            board->grid[i][j].number = 0;
+            int index = board_index(board, i, j);
+            board->cells[index].type = CELL_EMPTY;
+            board->open_dirs[index] = (unsigned char)(
+                (i > 0) << BOARD_UP | (i < height - 1) << BOARD_DOWN |
+                (j > 0) << BOARD_LEFT | (j < width - 1) << BOARD_RIGHT);
         }
     }
     
-    return board;
+    return true;
 }
 
 void board_free(Board *board) {
     if (!board) return;
-    for (int i = 0; i < board->height; i++) {
-        free(board->grid[i]);
-    }
-    free(board->grid);
+    free(board->cells);
+    free(board->open_dirs);
+    free(board->number_cells);
     free(board);
 }
 
+/* Drop index's entry from number_cells before its number changes */
+static void board_unindex_number(Board *board, int index) {
+    const Cell *cell = &board->cells[index];
+    if (cell->type == CELL_NUMBER &&
+        board_number_index(board, cell->number) == index) {
+        board->number_cells[cell->number] = 0;
+    }
+}
+
+/*
+ * Keep the neighbors' open_dirs bits pointing at index in step with its
+ * type. Direction d from index is direction d ^ 1 back from the neighbor.
+ */
+static void board_update_open_dirs(Board *board, int index) {
+    bool open = board->cells[index].type != CELL_WALL;
+    
+    for (int dir = 0; dir < 4; dir++) {
+        unsigned char back = (unsigned char)(1u << (dir ^ 1));
+        unsigned char *mask = &board->open_dirs[index + board->delta[dir]];
+        *mask = open ? (*mask | back) : (*mask & ~back);
+    }
+}
+
 void board_set_wall(Board *board, int row, int col) {
-    board->grid[row][col].type = CELL_WALL;
+    int index = board_index(board, row, col);
+    board_unindex_number(board, index);
+    board->cells[index].type = CELL_WALL;
+    board_update_open_dirs(board, index);
 }
 
 void board_set_number(Board *board, int row, int col, int number) {
-    board->grid[row][col].type = CELL_NUMBER;
-    board->grid[row][col].number = number;
+    int index = board_index(board, row, col);
+    Cell *cell = &board->cells[index];
+    bool was_wall = cell->type == CELL_WALL;
+    board_unindex_number(board, index);
+    cell->type = CELL_NUMBER;
+    if (was_wall) {
+        board_update_open_dirs(board, index);
+    }
+    cell->number = number;
+    if (number >= 1 && number <= board_cell_count(board)) {
+        board->number_cells[number] = index;
+    }
     if (number > board->max_number) {
         board->max_number = number;
     }
 }
 
+void board_set_rules(Board *board, BoardRules rules) {
+    board->rules = rules;
+}
+
 bool board_find_number(const Board *board, int number, int *row, int *col) {
+    if (number >= 1 && number <= board_cell_count(board)) {
+        int index = board_number_index(board, number);
+        if (index < 0) return false;
+        *row = board_index_row(board, index);
+        *col = board_index_col(board, index);
+        return true;
+    }
+    
     for (int i = 0; i < board->height; i++) {
         for (int j = 0; j < board->width; j++) {
-            if (board->grid[i][j].type == CELL_NUMBER && 
-                board->grid[i][j].number == number) {
+            const Cell *cell = board_cell(board, i, j);
+            if (cell->type == CELL_NUMBER && cell->number == number) {
                 *row = i;
                 *col = j;
                 return true;
@@ -76,6 +147,16 @@ bool board_find_number(const Board *board, int number, int *row, int *col) {
     return false;
 }
 
+int board_count_open_cells(const Board *board) {
+    int open = 0;
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            if (board_cell(board, i, j)->type != CELL_WALL) open++;
+        }
+    }
+    return open;
+}
+
 Board *create_puzzle(void) {
     Board *board = board_create(10, 10);
     if (!board) return NULL;
@@ -111,27 +192,8 @@ Board *create_puzzle(void) {
 
 /* ========== GAME STATE ========== */
 
-static bool **create_visited_grid(int rows, int cols) {
-    bool **visited = (bool **)malloc(rows * sizeof(bool *));
-    if (!visited) return NULL;
-    
-    for (int i = 0; i < rows; i++) {
-        visited[i] = (bool *)calloc(cols, sizeof(bool));
-        if (!visited[i]) {
-            for (int j = 0; j < i; j++) free(visited[j]);
-            free(visited);
-            return NULL;
-        }
-    }
-    return visited;
-}
-
-static void free_visited_grid(bool **visited, int rows) {
-    if (!visited) return;
-    for (int i = 0; i < rows; i++) {
-        free(visited[i]);
-    }
-    free(visited);
+static bool *create_visited_grid(const Board *board) {
+    return (bool *)calloc(board_cell_count(board), sizeof(bool));
 }
 
 GameState *game_state_create(const Board *board) {
@@ -141,7 +203,7 @@ GameState *game_state_create(const Board *board) {
     if (!state) return NULL;
     
     state->board = board;
-    state->visited = create_visited_grid(board->height, board->width);
+    state->visited = create_visited_grid(board);
     if (!state->visited) {
         free(state);
         return NULL;
@@ -149,7 +211,7 @@ GameState *game_state_create(const Board *board) {
     
     int start_row, start_col;
     if (!board_find_number(board, 1, &start_row, &start_col)) {
-        free_visited_grid(state->visited, board->height);
+        free(state->visited);
         free(state);
         return NULL;
     }
@@ -157,140 +219,219 @@ GameState *game_state_create(const Board *board) {
     state->player.row = start_row;
     state->player.col = start_col;
     state->player.next_number = 2;
-    state->visited[start_row][start_col] = true;
+    state->visited[board_index(board, start_row, start_col)] = true;
+    state->visited_hash = board_cell_key(board_index(board, start_row, start_col));
     
     return state;
 }
 
 void game_state_free(GameState *state) {
     if (!state) return;
-    free_visited_grid(state->visited, state->board->height);
+    free(state->visited);
     free(state);
 }
 
 bool game_state_check_win(const GameState *state) {
-    return state->player.next_number > state->board->max_number;
+    const Board *board = state->board;
+    
+    if (state->player.next_number <= board->max_number) return false;
+    if (board->rules != RULES_FULL_COVERAGE) return true;
+    
+    for (int i = 0; i < board_cell_count(board); i++) {
+        if (board->cells[i].type != CELL_WALL && !state->visited[i]) return false;
+    }
+    return true;
 }
 
 /* ========== MOVEMENT ========== */
 
-static bool is_in_bounds(const Board *board, int row, int col) {
-    return row >= 0 && row < board->height && col >= 0 && col < board->width;
+/* Board direction of a movement key, -1 for anything else */
+static int move_key_direction(char key) {
+    switch (key) {
+        case 'w': case 'W': return BOARD_UP;
+        case 's': case 'S': return BOARD_DOWN;
+        case 'a': case 'A': return BOARD_LEFT;
+        case 'd': case 'D': return BOARD_RIGHT;
+        default: return -1;
+    }
 }
 
-static bool is_valid_move(const GameState *state, int target_row, int target_col) {
-    const Board *board = state->board;
-    
-    if (!is_in_bounds(board, target_row, target_col)) return false;
+/* Off-board targets land on the padding ring, which is all walls */
+static bool is_valid_move(const GameState *state, int target) {
+    const Cell *cell = &state->board->cells[target];
+    if (cell->type == CELL_WALL) return false;
+    if (state->visited[target]) return false;
     
-    Cell target = board->grid[target_row][target_col];
-    if (target.type == CELL_WALL) return false;
-    if (state->visited[target_row][target_col]) return false;
+    /* Under full coverage the path ends on the last number */
+    if (state->board->rules == RULES_FULL_COVERAGE &&
+        state->player.next_number > state->board->max_number) return false;
     
-    if (target.type == CELL_NUMBER) {
-        if (target.number != state->player.next_number) return false;
+    if (cell->type == CELL_NUMBER) {
+        if (cell->number != state->player.next_number) return false;
     }
     
     return true;
 }
 
 bool movement_try_move(GameState *state, char direction) {
-    int new_row = state->player.row;
-    int new_col = state->player.col;
-    
-    switch (direction) {
-        case 'w': case 'W': new_row--; break;
-        case 's': case 'S': new_row++; break;
-        case 'a': case 'A': new_col--; break;
-        case 'd': case 'D': new_col++; break;
-        default: return false;
-    }
+    int dir = move_key_direction(direction);
+    if (dir < 0) return false;
     
-    if (!is_valid_move(state, new_row, new_col)) return false;
+    const Board *board = state->board;
+    int target = board_index(board, state->player.row, state->player.col) +
+                 board->delta[dir];
+    if (!is_valid_move(state, target)) return false;
     
-    const Cell *target = &state->board->grid[new_row][new_col];
-    if (target->type == CELL_NUMBER) {
+    if (board->cells[target].type == CELL_NUMBER) {
         state->player.next_number++;
     }
     
-    state->visited[new_row][new_col] = true;
-    state->player.row = new_row;
-    state->player.col = new_col;
+    state->visited[target] = true;
+    state->visited_hash ^= board_cell_key(target);
+    state->player.row = board_index_row(board, target);
+    state->player.col = board_index_col(board, target);
     
     return true;
 }
 
-/* ========== UNDO ========== */
+/* ========== MOVE JOURNAL ========== */
 
-typedef struct {
-    int prev_row, prev_col;
-    int prev_next_number;
-    int target_row, target_col;
-} UndoState;
+struct MoveJournal {
+    char *moves;    /* movement_try_move() keys, oldest first */
+    int length;     /* moves recorded, including undone ones */
+    int position;   /* moves currently applied to the game */
+    int capacity;
+};
 
-typedef struct StackNode {
-    UndoState state;
-    struct StackNode *next;
-} StackNode;
+#define MOVE_JOURNAL_INITIAL_CAPACITY 64
 
-struct UndoStack {
-    StackNode *top;
-    int size;
-};
+MoveJournal *move_journal_create(void) {
+    MoveJournal *journal = (MoveJournal *)malloc(sizeof(MoveJournal));
+    if (!journal) return NULL;
+    
+    journal->moves = (char *)malloc(MOVE_JOURNAL_INITIAL_CAPACITY);
+    if (!journal->moves) {
+        free(journal);
+        return NULL;
+    }
+    journal->length = 0;
+    journal->position = 0;
+    journal->capacity = MOVE_JOURNAL_INITIAL_CAPACITY;
+    return journal;
+}
 
-UndoStack *undo_stack_create(void) {
-    UndoStack *stack = (UndoStack *)malloc(sizeof(UndoStack));
-    if (!stack) return NULL;
-    stack->top = NULL;
-    stack->size = 0;
-    return stack;
+void move_journal_free(MoveJournal *journal) {
+    if (!journal) return;
+    free(journal->moves);
+    free(journal);
 }
 
-void undo_stack_free(UndoStack *stack) {
-    if (!stack) return;
-    while (stack->top != NULL) {
-        StackNode *node = stack->top;
-        stack->top = node->next;
-        free(node);
+void move_journal_clear(MoveJournal *journal) {
+    if (!journal) return;
+    journal->length = 0;
+    journal->position = 0;
+}
+
+bool move_journal_try_move(MoveJournal *journal, GameState *state, char direction) {
+    if (!journal || !state) return false;
+    
+    /* Make room first, so a rejected move never needs rolling back */
+    if (journal->position == journal->capacity) {
+        int capacity = journal->capacity * 2;
+        char *moves = (char *)realloc(journal->moves, capacity);
+        if (!moves) return false;
+        journal->moves = moves;
+        journal->capacity = capacity;
     }
-    free(stack);
+    
+    if (!movement_try_move(state, direction)) return false;
+    
+    /* A new move replaces whatever was undone past this point */
+    journal->moves[journal->position++] = direction;
+    journal->length = journal->position;
+    return true;
 }
 
-bool undo_stack_push(UndoStack *stack, const GameState *state, int target_row, int target_col) {
-    if (!stack || !state) return false;
+/*
+ * The last applied move is recoverable from the board alone: the player
+ * came from one step against its direction, and entering a number cell
+ * is what advanced next_number
+ */
+bool move_journal_undo(MoveJournal *journal, GameState *state) {
+    if (!journal || !state || journal->position == 0) return false;
     
-    StackNode *node = (StackNode *)malloc(sizeof(StackNode));
-    if (!node) return false;
+    const Board *board = state->board;
+    int dir = move_key_direction(journal->moves[journal->position - 1]);
+    int target = board_index(board, state->player.row, state->player.col);
+    int prev = target - board->delta[dir];
+    
+    state->visited[target] = false;
+    state->visited_hash ^= board_cell_key(target);
+    if (board->cells[target].type == CELL_NUMBER) {
+        state->player.next_number--;
+    }
+    state->player.row = board_index_row(board, prev);
+    state->player.col = board_index_col(board, prev);
     
-    node->state.prev_row = state->player.row;
-    node->state.prev_col = state->player.col;
-    node->state.prev_next_number = state->player.next_number;
-    node->state.target_row = target_row;
-    node->state.target_col = target_col;
+    journal->position--;
+    return true;
+}
+
+bool move_journal_redo(MoveJournal *journal, GameState *state) {
+    if (!journal || !state || journal->position == journal->length) return false;
+    if (!movement_try_move(state, journal->moves[journal->position])) return false;
+    journal->position++;
+    return true;
+}
+
+bool move_journal_seek(MoveJournal *journal, GameState *state, int move) {
+    if (!journal || !state || move < 0 || move > journal->length) return false;
     
-    node->next = stack->top;
-    stack->top = node;
-    stack->size++;
+    while (journal->position > move) {
+        move_journal_undo(journal, state);
+    }
+    while (journal->position < move) {
+        if (!move_journal_redo(journal, state)) return false;
+    }
     return true;
 }
 
-bool undo_stack_pop(UndoStack *stack, GameState *state) {
-    if (!stack || !state || stack->top == NULL) return false;
+bool move_journal_load(MoveJournal *journal, const char *moves, int count) {
+    if (!journal || count < 0 || (count > 0 && !moves)) return false;
     
-    StackNode *node = stack->top;
-    UndoState undo = node->state;
+    for (int i = 0; i < count; i++) {
+        if (move_key_direction(moves[i]) < 0) return false;
+    }
     
-    state->player.row = undo.prev_row;
-    state->player.col = undo.prev_col;
-    state->player.next_number = undo.prev_next_number;
-    state->visited[undo.target_row][undo.target_col] = false;
+    if (count > journal->capacity) {
+        char *grown = (char *)realloc(journal->moves, count);
+        if (!grown) return false;
+        journal->moves = grown;
+        journal->capacity = count;
+    }
     
-    stack->top = node->next;
-    stack->size--;
-    free(node);
+    memcpy(journal->moves, moves, count);
+    journal->length = count;
+    journal->position = 0;
     return true;
 }
 
-bool undo_stack_is_empty(const UndoStack *stack) {
-    return stack == NULL || stack->top == NULL;
+int move_journal_replay(const MoveJournal *journal, GameState *state, int count) {
+    if (!journal || !state) return 0;
+    if (count < 0 || count > journal->length) count = journal->length;
+    
+    int applied = 0;
+    while (applied < count && movement_try_move(state, journal->moves[applied])) {
+        applied++;
+    }
+    return applied;
+}
+
+const char *move_journal_moves(const MoveJournal *journal, int *length) {
+    if (length) *length = journal ? journal->length : 0;
+    return journal ? journal->moves : NULL;
+}
+
+int move_journal_position(const MoveJournal *journal) {
+    return journal ? journal->position : 0;
 }
@@ -6,6 +6,7 @@
 #define ENGINE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
     CELL_EMPTY,
@@ -24,26 +25,139 @@ typedef struct {
     int next_number;
 } PlayerState;
 
+/*
+ * What counts as solving a board
+ * 
+ *   RULES_REACH_LAST    - Visit the numbers in order; the puzzle is won
+ *                         once the last number is reached
+ *   RULES_FULL_COVERAGE - Same, and the path must also fill every
+ *                         non-wall cell, ending on the last number
+ *                         (a Hamiltonian path, as in the real game)
+ * 
+ * The engine, both solvers and the generator honor the board's rules.
+ */
+typedef enum {
+    RULES_REACH_LAST,
+    RULES_FULL_COVERAGE
+} BoardRules;
+
+/*
+ * Cells live in one row-major block surrounded by a ring of BOARD_PADDING
+ * wall cells, so a step off any edge lands on a wall and neighbor lookups
+ * need no bounds checks. Use board_index()/board_cell() instead of
+ * indexing cells directly.
+ * 
+ * Neighbors: cell i's neighbor in direction d (BOARD_UP..BOARD_RIGHT) is
+ * i + delta[d], and bit d of open_dirs[i] is set when that neighbor is
+ * not a wall. The setters keep open_dirs current, so solvers iterate the
+ * mask and never step onto a wall.
+ */
+#define BOARD_PADDING 1
+
+enum {
+    BOARD_UP,
+    BOARD_DOWN,
+    BOARD_LEFT,
+    BOARD_RIGHT
+};
+
 typedef struct {
     int height;
     int width;
     int max_number;
-    Cell **grid;
+    int stride;     /* width + 2 * BOARD_PADDING */
+    Cell *cells;    /* (height + 2 * BOARD_PADDING) * stride cells */
+    BoardRules rules;   /* RULES_REACH_LAST unless board_set_rules() */
+    int delta[4];   /* index offset per direction */
+    unsigned char *open_dirs;   /* per cell: non-wall neighbor mask */
+    int *number_cells;  /* number -> cell index (0: absent), see below */
+    int capacity;   /* cells the arrays hold, for board_reset() */
 } Board;
 
 typedef struct {
     const Board *board;
-    bool **visited;
+    bool *visited;  /* indexed by board_index(), same size as board->cells */
+    uint64_t visited_hash;  /* XOR of board_cell_key() over visited cells */
     PlayerState player;
 } GameState;
 
-typedef struct UndoStack UndoStack;
+static inline int board_index(const Board *board, int row, int col) {
+    return (row + BOARD_PADDING) * board->stride + (col + BOARD_PADDING);
+}
+
+static inline int board_index_row(const Board *board, int index) {
+    return index / board->stride - BOARD_PADDING;
+}
+
+static inline int board_index_col(const Board *board, int index) {
+    return index % board->stride - BOARD_PADDING;
+}
+
+static inline int board_cell_count(const Board *board) {
+    return (board->height + 2 * BOARD_PADDING) * board->stride;
+}
+
+static inline const Cell *board_cell(const Board *board, int row, int col) {
+    return &board->cells[board_index(board, row, col)];
+}
+
+/*
+ * Zobrist key of a cell index (splitmix64 finalizer): a set of cells
+ * hashes to the XOR of its keys, updated with one XOR per cell added or
+ * removed, and equal hashes mean equal sets to within 2^-64
+ */
+static inline uint64_t board_cell_key(int index) {
+    uint64_t x = (uint64_t)index + 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/*
+ * Cell index of number, or -1 when it is not on the board
+ * 
+ * board_set_number() and board_set_wall() keep number_cells current for
+ * numbers 1..board_cell_count() (cell 0 is padding, so 0 marks a gap).
+ * No board holds more distinct numbers than cells; anything larger is
+ * reported absent here and only found by board_find_number()'s scan.
+ */
+static inline int board_number_index(const Board *board, int number) {
+    if (number < 1 || number > board_cell_count(board)) return -1;
+    int index = board->number_cells[number];
+    return index > 0 ? index : -1;
+}
+
+/*
+ * Reorder a direction mask so moves toward target are tried first
+ * 
+ * Directions from pos that shrink the Manhattan distance to target keep
+ * their bit in 0-3; the others move up to bits 4-7. Taking
+ * __builtin_ctz(moves) & 3 and clearing the lowest bit then visits
+ * closer directions first, in BOARD_UP..BOARD_RIGHT order within each
+ * group. A negative target leaves moves as it is.
+ */
+static inline unsigned board_moves_toward(const Board *board, int pos,
+                                          int target, unsigned moves) {
+    if (target < 0) return moves;
+    int row = pos / board->stride, col = pos - row * board->stride;
+    int target_row = target / board->stride;
+    int target_col = target - target_row * board->stride;
+    unsigned closer = (target_row < row) << BOARD_UP |
+                      (target_row > row) << BOARD_DOWN |
+                      (target_col < col) << BOARD_LEFT |
+                      (target_col > col) << BOARD_RIGHT;
+    return (moves & closer) | (moves & ~closer) << 4;
+}
 
 Board *board_create(int height, int width);
 void board_free(Board *board);
+/* Empty height x width board in place; false if it needs more capacity */
+bool board_reset(Board *board, int height, int width);
 void board_set_wall(Board *board, int row, int col);
 void board_set_number(Board *board, int row, int col, int number);
+void board_set_rules(Board *board, BoardRules rules);
 bool board_find_number(const Board *board, int number, int *row, int *col);
+int board_count_open_cells(const Board *board);  /* non-wall cells */
 Board *create_puzzle(void);
 
 GameState *game_state_create(const Board *board);
@@ -52,10 +166,36 @@ bool game_state_check_win(const GameState *state);
 
 bool movement_try_move(GameState *state, char direction);
 
-UndoStack *undo_stack_create(void);
-void undo_stack_free(UndoStack *stack);
-bool undo_stack_push(UndoStack *stack, const GameState *state, int target_row, int target_col);
-bool undo_stack_pop(UndoStack *stack, GameState *state);
-bool undo_stack_is_empty(const UndoStack *stack);
+/*
+ * Move journal: the game's history as one byte per move
+ * 
+ * Moves are the movement_try_move() keys, kept in one growable array, so
+ * recording a move costs no allocation once the array has grown to fit.
+ * position counts the moves applied to the game; undone moves stay past
+ * it for redo until a new move replaces them.
+ * 
+ *   move_journal_try_move() - movement_try_move(), recorded on success
+ *   move_journal_undo/redo  - Step back or forward by one move
+ *   move_journal_seek()     - Undo or redo until move moves are applied
+ *   move_journal_replay()   - Apply the first count moves (< 0: all) to a
+ *                             fresh GameState; returns how many applied
+ *   move_journal_moves()    - The recorded moves, for saving; load them
+ *                             back with move_journal_load() (position 0)
+ * 
+ * undo/redo/seek expect state to be the game the journal recorded.
+ */
+typedef struct MoveJournal MoveJournal;
+
+MoveJournal *move_journal_create(void);
+void move_journal_free(MoveJournal *journal);
+void move_journal_clear(MoveJournal *journal);
+bool move_journal_try_move(MoveJournal *journal, GameState *state, char direction);
+bool move_journal_undo(MoveJournal *journal, GameState *state);
+bool move_journal_redo(MoveJournal *journal, GameState *state);
+bool move_journal_seek(MoveJournal *journal, GameState *state, int move);
+bool move_journal_load(MoveJournal *journal, const char *moves, int count);
+int move_journal_replay(const MoveJournal *journal, GameState *state, int count);
+const char *move_journal_moves(const MoveJournal *journal, int *length);
+int move_journal_position(const MoveJournal *journal);
 
 #endif
@@ -17,7 +17,6 @@
 #include "generator.h"
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 /* ============================================================================
  * PATH TRACKING STRUCTURE
@@ -82,13 +81,9 @@ static void path_list_free(PathList *list) {
 /* ============================================================================
  * HELPER FUNCTIONS
  * ============================================================================ */
-static bool is_in_inner_bounds(int rows, int cols, int row, int col) {
-    return row > 0 && row < rows - 1 && col > 0 && col < cols - 1;
-}
-
-static void shuffle_array(int *array, int size) {
+static void shuffle_array(Rng *rng, int *array, int size) {
     for (int i = size - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = (int)rng_below(rng, (uint32_t)(i + 1));
         int temp = array[i];
         array[i] = array[j];
         array[j] = temp;
@@ -98,73 +93,116 @@ static void shuffle_array(int *array, int size) {
 /* ============================================================================
  * DFS PATH GENERATION
  * ============================================================================ */
-static bool generate_path_dfs(
-    bool **visited,
-    PathList *path,
-    int rows,
-    int cols,
-    int row,
-    int col,
-    int target_length,
-    int current_length
-) {
-    visited[row][col] = true;
-    if (!path_list_append(path, row, col)) {
-        return false;
+/*
+ * One explicit stack frame per path cell. order packs the shuffled
+ * direction sequence two bits per entry; dir is the next slot to try.
+ */
+typedef struct {
+    int pos;
+    unsigned char order;
+    unsigned char dir;
+} PathFrame;
+
+/*
+ * Append the walk's path to path: the chain of parents from the deepest
+ * cell back to the start, in start-to-end order. stack is reused as
+ * scratch since the walk is over.
+ */
+static bool collect_path(const Board *board, const int *parent, PathFrame *stack,
+                         PathList *path, int deepest) {
+    int length = 0;
+    for (int pos = deepest; pos >= 0; pos = parent[pos]) {
+        stack[length++].pos = pos;
     }
     
-    if (current_length >= target_length) {
-        return true;
+    for (int i = length - 1; i >= 0; i--) {
+        if (!path_list_append(path, board_index_row(board, stack[i].pos),
+                              board_index_col(board, stack[i].pos))) {
+            return false;
+        }
     }
+    return true;
+}
+
+/*
+ * visited covers the padded board; the border ring and the padding are
+ * pre-marked, so the walk stays on inner cells without bounds checks.
+ * 
+ * Runs on an explicit heap stack (one frame per cell, so at most one per
+ * board cell). Cells are never unmarked, so the walk is linear in the
+ * board size. The path handed back is the simple path from start to the
+ * deepest cell reached (parent links, one per cell), never the dead ends
+ * the walk backed out of, so consecutive numbers are always adjacent.
+ */
+static bool generate_path_dfs(
+    Rng *rng,
+    const Board *board,
+    bool *visited,
+    int *parent,
+    PathList *path,
+    PathFrame *stack,
+    int start,
+    int target_length
+) {
+    int depth = 0;
+    int pos = start;
+    int deepest = start;
+    int deepest_length = 0;
     
-    int dr[] = {-1, 1, 0, 0};
-    int dc[] = {0, 0, -1, 1};
-    
-    int directions[] = {0, 1, 2, 3};
-    shuffle_array(directions, 4);
+    parent[start] = -1;
     
-    for (int i = 0; i < 4; i++) {
-        int dir = directions[i];
-        int new_row = row + dr[dir];
-        int new_col = col + dc[dir];
+    for (;;) {
+        /* Enter pos */
+        visited[pos] = true;
+        
+        if (depth + 1 > deepest_length) {
+            deepest = pos;
+            deepest_length = depth + 1;
+        }
+        
+        if (depth + 1 >= target_length) {
+            return collect_path(board, parent, stack, path, deepest);
+        }
+        
+        int directions[] = {0, 1, 2, 3};
+        shuffle_array(rng, directions, 4);
         
-        if (is_in_inner_bounds(rows, cols, new_row, new_col) &&
-            !visited[new_row][new_col]) {
+        stack[depth++] = (PathFrame){
+            pos,
+            (unsigned char)(directions[0] | directions[1] << 2 |
+                            directions[2] << 4 | directions[3] << 6),
+            0
+        };
+        
+        /* Find the next unvisited neighbor, backtracking as needed */
+        pos = -1;
+        while (depth > 0 && pos < 0) {
+            PathFrame *top = &stack[depth - 1];
             
-            if (generate_path_dfs(visited, path, rows, cols,
-                                 new_row, new_col, target_length,
-                                 current_length + 1)) {
-                return true;  
+            if (top->dir == 4) {
+                depth--;
+                continue;
             }
-        }
-    }
-    
-    return false;
-}
-static bool **create_visited_grid(int rows, int cols) {
-    bool **visited = (bool **)malloc(rows * sizeof(bool *));
-    if (!visited) return NULL;
-    
-    for (int i = 0; i < rows; i++) {
-        visited[i] = (bool *)calloc(cols, sizeof(bool));
-        if (!visited[i]) {
-            for (int j = 0; j < i; j++) {
-                free(visited[j]);
+            
+            int dir = (top->order >> (2 * top->dir++)) & 3;
+            int new_pos = top->pos + board->delta[dir];
+            
+            if (!visited[new_pos]) {
+                pos = new_pos;
+                parent[pos] = top->pos;
             }
-            free(visited);
-            return NULL;
+        }
+        
+        if (pos < 0) {
+            /* Too short: keep the longest path for the caller anyway */
+            collect_path(board, parent, stack, path, deepest);
+            return false;
         }
     }
-    
-    return visited;
 }
 
-static void free_visited_grid(bool **visited, int rows) {
-    if (!visited) return;
-    for (int i = 0; i < rows; i++) {
-        free(visited[i]);
-    }
-    free(visited);
+static bool *create_visited_grid(const Board *board) {
+    return (bool *)calloc(board_cell_count(board), sizeof(bool));
 }
 
 /* ============================================================================
@@ -194,11 +232,12 @@ static void place_numbers_on_path(Board *board, PathList *path) {
 }
 
 
-static void add_random_walls(Board *board, bool **visited, float wall_ratio) {
+/* Runs after place_numbers_on_path: every cell left empty is off the path */
+static void add_random_walls(Rng *rng, Board *board, float wall_ratio) {
     for (int row = 1; row < board->height - 1; row++) {
         for (int col = 1; col < board->width - 1; col++) {
-            if (!visited[row][col]) {
-                if ((float)rand() / RAND_MAX < wall_ratio) {
+            if (board_cell(board, row, col)->type == CELL_EMPTY) {
+                if (rng_chance(rng, wall_ratio)) {
                     board_set_wall(board, row, col);
                 }
             }
@@ -210,14 +249,19 @@ static void add_random_walls(Board *board, bool **visited, float wall_ratio) {
  * PUBLIC API
  * ============================================================================ */
 
-Board *generate_puzzle(
+static Board *generate_puzzle_timed(
     int rows,
     int cols,
     float path_ratio,
     float wall_ratio,
-    unsigned int seed
+    Rng *rng,
+    SearchStats *stats
 ) {
     
+    if (!rng) {
+        return NULL;
+    }
+    
     if (rows < 5 || cols < 5) {
         return NULL;  /* Too small for meaningful puzzle */
     }
@@ -231,8 +275,6 @@ Board *generate_puzzle(
         return NULL;  /* Invalid ratio */
     }
     
-    srand(seed);
-    
     Board *board = board_create(rows, cols);
     if (!board) {
         return NULL;
@@ -247,67 +289,133 @@ Board *generate_puzzle(
         target_length = 3;
     }
     
-    bool **visited = create_visited_grid(rows, cols);
+    bool *visited = create_visited_grid(board);
     if (!visited) {
         board_free(board);
         return NULL;
     }
     
-    for (int col = 0; col < cols; col++) {
-        visited[0][col] = true;
-        visited[rows - 1][col] = true;
-    }
-    for (int row = 0; row < rows; row++) {
-        visited[row][0] = true;
-        visited[row][cols - 1] = true;
+    /* Walls (border ring and padding) are never part of the path */
+    for (int i = 0; i < board_cell_count(board); i++) {
+        visited[i] = board->cells[i].type == CELL_WALL;
     }
     
+    PathFrame *stack = (PathFrame *)malloc(board_cell_count(board) * sizeof(PathFrame));
+    int *parent = (int *)malloc(board_cell_count(board) * sizeof(int));
     PathList *path = path_list_create();
-    if (!path) {
-        free_visited_grid(visited, rows);
+    if (!stack || !parent || !path) {
+        free(stack);
+        free(parent);
+        path_list_free(path);
+        free(visited);
         board_free(board);
         return NULL;
     }
     bool success = false;
     const int MAX_ATTEMPTS = 10;
+    double phase_start = stats ? search_stats_now() : 0.0;
     
     for (int attempt = 0; attempt < MAX_ATTEMPTS && !success; attempt++) {
         path_list_free(path);
         path = path_list_create();
         if (!path) {
-            free_visited_grid(visited, rows);
+            free(stack);
+            free(parent);
+            free(visited);
             board_free(board);
             return NULL;
         }
         
         for (int row = 1; row < rows - 1; row++) {
             for (int col = 1; col < cols - 1; col++) {
-                visited[row][col] = false;
+                visited[board_index(board, row, col)] = false;
             }
         }
         
-        int start_row = 1 + rand() % (rows - 2);
-        int start_col = 1 + rand() % (cols - 2);
+        int start_row = 1 + (int)rng_below(rng, (uint32_t)(rows - 2));
+        int start_col = 1 + (int)rng_below(rng, (uint32_t)(cols - 2));
         
         success = generate_path_dfs(
-            visited, path, rows, cols,
-            start_row, start_col,
-            target_length, 1
+            rng, board, visited, parent, path, stack,
+            board_index(board, start_row, start_col),
+            target_length
         );
     }
     
+    free(stack);
+    free(parent);
+    
     if (path->length < 3) {
         /* Path too short - fail gracefully */
         path_list_free(path);
-        free_visited_grid(visited, rows);
+        free(visited);
         board_free(board);
         return NULL;
     }
     place_numbers_on_path(board, path);
-        add_random_walls(board, visited, wall_ratio);
+    
+    if (stats) {
+        double now = search_stats_now();
+        stats->phase_seconds[STATS_PHASE_PATH_DFS] += now - phase_start;
+        phase_start = now;
+    }
+    
+    add_random_walls(rng, board, wall_ratio);
+    
+    if (stats) {
+        stats->phase_seconds[STATS_PHASE_WALL_PLACEMENT] +=
+            search_stats_now() - phase_start;
+    }
     
     path_list_free(path);
-    free_visited_grid(visited, rows);
+    free(visited);
     
     return board;
 }
+
+Board *generate_puzzle_rng(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    Rng *rng
+) {
+    return generate_puzzle_timed(rows, cols, path_ratio, wall_ratio, rng, NULL);
+}
+
+Board *generate_puzzle_stats(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    SearchStats *stats
+) {
+    Rng rng;
+    rng_seed(&rng, seed);
+    return generate_puzzle_timed(rows, cols, path_ratio, wall_ratio, &rng, stats);
+}
+
+Board *generate_puzzle(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed
+) {
+    return generate_puzzle_stats(rows, cols, path_ratio, wall_ratio, seed, NULL);
+}
+
+Board *generate_coverage_puzzle(
+    int rows,
+    int cols,
+    float path_ratio,
+    unsigned int seed
+) {
+    /* A wall ratio of 1 walls every cell the path left empty */
+    Board *board = generate_puzzle(rows, cols, path_ratio, 1.0f, seed);
+    if (board) {
+        board_set_rules(board, RULES_FULL_COVERAGE);
+    }
+    return board;
+}
@@ -6,7 +6,38 @@
 #define GENERATOR_H
 
 #include "engine.h"
+#include "rng.h"
+#include "search_stats.h"
 
+/*
+ * Numbers 1..N follow a simple path of adjacent cells, so the board
+ * always has a solution. The same seed gives a bit-identical board on
+ * every platform (pinned by `make check`); each call keeps its own
+ * generator state, so calls may run concurrently.
+ */
 Board *generate_puzzle(int rows, int cols, float path_ratio, float wall_ratio, unsigned int seed);
 
+/*
+ * generate_puzzle() drawing from a caller-owned generator, which is left
+ * advanced past every draw this puzzle used
+ */
+Board *generate_puzzle_rng(int rows, int cols, float path_ratio, float wall_ratio, Rng *rng);
+
+/*
+ * Full-coverage puzzle (RULES_FULL_COVERAGE)
+ * 
+ * Every cell off the random path becomes a wall, so filling the open
+ * cells means walking exactly that path. All path cells are numbered;
+ * pass the board to minimize_clues() (generator_clues.h) to thin the
+ * clues out while keeping the covering path unique.
+ */
+Board *generate_coverage_puzzle(int rows, int cols, float path_ratio, unsigned int seed);
+
+/*
+ * generate_puzzle() that adds its path DFS and wall placement time to
+ * stats (NULL records nothing)
+ */
+Board *generate_puzzle_stats(int rows, int cols, float path_ratio, float wall_ratio,
+                             unsigned int seed, SearchStats *stats);
+
 #endif
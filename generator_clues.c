@@ -0,0 +1,175 @@
+/*
+ * generator_clues.c - Sparse-Clue Puzzle Generator Implementation
+ * 
+ * Removal Pipeline:
+ * 1. Collect the clue cells in number order
+ * 2. Visit the inner clues in a seeded random order
+ * 3. Drop a clue if the board without it is still unique
+ * 4. Stop at the target clue count or when every clue has been tried
+ * 
+ * One pass is enough: removing clues only ever adds solutions, so a clue
+ * that could not be removed earlier cannot be removed later either.
+ */
+
+#include "generator_clues.h"
+#include "generator_unique.h"
+#include "rng.h"
+#include "solver_count.h"
+#include <stdlib.h>
+
+/*
+ * Copy walls from src and place the kept clues except skip, renumbered
+ * 1..K in their original order. If skip >= 0, *skip_number receives the
+ * number the path heads for when it passes the skipped cell.
+ */
+static Board *build_clue_board(const Board *src, const int *clue_pos,
+                               const bool *kept, int clue_count,
+                               int skip, int *skip_number) {
+    Board *board = board_create(src->height, src->width);
+    if (!board) return NULL;
+    board_set_rules(board, src->rules);
+    
+    for (int i = 0; i < src->height; i++) {
+        for (int j = 0; j < src->width; j++) {
+            if (board_cell(src, i, j)->type == CELL_WALL) {
+                board_set_wall(board, i, j);
+            }
+        }
+    }
+    
+    int number = 0;
+    for (int k = 1; k <= clue_count; k++) {
+        if (k == skip) {
+            if (skip_number) *skip_number = number + 1;
+            continue;
+        }
+        if (!kept[k]) continue;
+        
+        board_set_number(board, board_index_row(src, clue_pos[k]),
+                         board_index_col(src, clue_pos[k]), ++number);
+    }
+    
+    return board;
+}
+
+Board *minimize_clues(const Board *board, int target_clues, unsigned int seed) {
+    return minimize_clues_stats(board, target_clues, seed, NULL);
+}
+
+Board *minimize_clues_stats(const Board *board, int target_clues, unsigned int seed,
+                            SearchStats *stats) {
+    if (!board || !board->cells || board->max_number < 1) {
+        return NULL;
+    }
+    
+    int clue_count = board->max_number;
+    if (target_clues < 2) {
+        target_clues = 2;
+    }
+    
+    int *clue_pos = (int *)calloc(clue_count + 1, sizeof(int));
+    bool *kept = (bool *)calloc(clue_count + 1, sizeof(bool));
+    int *order = (int *)malloc((clue_count + 1) * sizeof(int));
+    if (!clue_pos || !kept || !order) {
+        free(clue_pos);
+        free(kept);
+        free(order);
+        return NULL;
+    }
+    
+    for (int i = 0; i < board_cell_count(board); i++) {
+        const Cell *cell = &board->cells[i];
+        if (cell->type == CELL_NUMBER &&
+            cell->number >= 1 && cell->number <= clue_count) {
+            clue_pos[cell->number] = i;
+            kept[cell->number] = true;
+        }
+    }
+    
+    /* Inner clues 2..N-1 in random order */
+    Rng rng;
+    rng_seed(&rng, seed);
+    int order_count = 0;
+    for (int k = 2; k < clue_count; k++) {
+        order[order_count++] = k;
+    }
+    for (int i = order_count - 1; i > 0; i--) {
+        int j = (int)rng_below(&rng, (uint32_t)(i + 1));
+        int temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
+    }
+    
+    int kept_count = clue_count;
+    bool spent = false;     /* stats->node_limit ran out */
+    for (int i = 0; i < order_count && kept_count > target_clues; i++) {
+        int k = order[i];
+        int heading_for = 0;
+        
+        Board *reduced = build_clue_board(board, clue_pos, kept, clue_count,
+                                          k, &heading_for);
+        if (!reduced) break;
+        
+        /* The old board was unique, so any other solution of the reduced
+         * board must skip clue k's cell in the segment it used to split */
+        int others = puzzle_count_solutions_avoiding(
+            reduced, 1,
+            board_index_row(board, clue_pos[k]),
+            board_index_col(board, clue_pos[k]),
+            heading_for,
+            stats
+        );
+        board_free(reduced);
+        
+        if (others < 0) {
+            spent = true;
+            break;
+        }
+        if (others == 0) {
+            kept[k] = false;
+            kept_count--;
+        }
+    }
+    
+    Board *result = spent ? NULL :
+                    build_clue_board(board, clue_pos, kept, clue_count, -1, NULL);
+    
+    free(clue_pos);
+    free(kept);
+    free(order);
+    return result;
+}
+
+Board *generate_sparse_puzzle(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int target_clues
+) {
+    return generate_sparse_puzzle_stats(rows, cols, path_ratio, wall_ratio,
+                                        seed, max_attempts, target_clues, NULL);
+}
+
+Board *generate_sparse_puzzle_stats(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int target_clues,
+    SearchStats *stats
+) {
+    Board *full = generate_unique_puzzle_stats(rows, cols, path_ratio, wall_ratio,
+                                               seed, max_attempts, stats);
+    if (!full) {
+        return NULL;
+    }
+    
+    Board *sparse = minimize_clues_stats(full, target_clues, seed, stats);
+    board_free(full);
+    return sparse;
+}
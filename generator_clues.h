@@ -0,0 +1,74 @@
+/*
+ * generator_clues.h - Sparse-Clue Puzzle Generator
+ * 
+ * Generated puzzles number every path cell. Real Zip boards show only a
+ * handful of checkpoints, so this stage removes numbers from a unique
+ * puzzle for as long as its solution stays unique.
+ */
+
+#ifndef GENERATOR_CLUES_H
+#define GENERATOR_CLUES_H
+
+#include "engine.h"
+#include "search_stats.h"
+
+/*
+ * Remove clues from a puzzle with a unique solution
+ * 
+ * Parameters:
+ *   board        - Puzzle with exactly one solution (not modified)
+ *   target_clues - Stop once this many numbers remain (at least 2:
+ *                  the first and last number are always kept)
+ *   seed         - Order in which clues are tried
+ * 
+ * Returns:
+ *   New board (caller frees) with the remaining clues renumbered 1..K
+ *   and the same unique solution, or NULL on invalid input or
+ *   allocation failure. K is above target_clues when no further clue
+ *   can be removed without losing uniqueness.
+ * 
+ * Performance:
+ *   Each removal is checked with puzzle_count_solutions_avoiding(),
+ *   which reuses the previous uniqueness result instead of counting the
+ *   reduced board from scratch.
+ */
+Board *minimize_clues(const Board *board, int target_clues, unsigned int seed);
+
+/*
+ * minimize_clues() that adds its counts to stats (may be NULL)
+ * 
+ * With stats->node_limit set, returns NULL once the removal checks
+ * have spent it (see generate_unique_puzzle_stats()).
+ */
+Board *minimize_clues_stats(const Board *board, int target_clues, unsigned int seed,
+                            SearchStats *stats);
+
+/*
+ * generate_unique_puzzle() followed by minimize_clues()
+ */
+Board *generate_sparse_puzzle(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int target_clues
+);
+
+/*
+ * generate_sparse_puzzle() through generate_unique_puzzle_stats() and
+ * minimize_clues_stats(), both recording into stats (may be NULL)
+ */
+Board *generate_sparse_puzzle_stats(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int target_clues,
+    SearchStats *stats
+);
+
+#endif /* GENERATOR_CLUES_H */
@@ -3,17 +3,86 @@
  * 
  * Generation Pipeline:
  * 1. Generate puzzle using path-first algorithm
- * 2. Count solutions (stop at 2)
+ * 2. Count solutions (stop at 2), keeping the alternative path
  * 3. If unique (count==1): return
- * 4. If not unique: discard and retry
- * 5. Repeat until unique puzzle found or max_attempts exceeded
+ * 4. If not unique: wall off the cell where the alternative leaves the
+ *    intended path and go back to 2, up to the repair budget
+ * 5. Otherwise discard and retry with the next seed
+ * 6. Repeat until unique puzzle found or max_attempts exceeded
  */
 
 #include "generator_unique.h"
+#include "board_hash.h"
 #include "generator.h"
+#include "rng.h"
 #include "solver_count.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+/* ============================================================================
+ * WITNESS-GUIDED REPAIR
+ * ============================================================================ */
+
+/*
+ * Cell where the alternative solution leaves the intended path, or -1
+ * 
+ * The generator numbers every path cell, so the intended solution is the
+ * number cells in order. At the first index where the witness differs it
+ * has to step onto an empty cell (the only number it could enter is the
+ * intended next one), and walling that cell keeps the intended path.
+ */
+static int find_divergence(const Board *board, const int *witness, int length) {
+    for (int i = 0; i < length; i++) {
+        const Cell *cell = &board->cells[witness[i]];
+        if (cell->type != CELL_NUMBER || cell->number != i + 1) {
+            return cell->type == CELL_EMPTY ? witness[i] : -1;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Wall off alternatives until the board is unique or the budget is spent
+ * 
+ * Returns the final solution count (1 on success), or -1 once
+ * stats->node_limit is spent. witness needs room for
+ * board_cell_count(board) entries. Pinned to GRID, the only engine that
+ * hands back a witness (see generator_unique.h).
+ */
+static int repair_until_unique(Board *board, int *witness, int repair_budget,
+                               SearchStats *stats) {
+    double start = stats ? search_stats_now() : 0.0;
+    int length = 0;
+    int count = puzzle_count_solutions_witness(board, 2, witness, &length, stats);
+    
+    for (int repair = 0; count >= 2 && repair < repair_budget; repair++) {
+        int cell = find_divergence(board, witness, length);
+        
+        if (cell < 0) {
+            /* The witness is the intended path, which means the other
+             * solution was met first: a limit of 1 stops right on it */
+            if (puzzle_count_solutions_witness(board, 1, witness, &length, stats) < 0) {
+                count = -1;
+                break;
+            }
+            cell = find_divergence(board, witness, length);
+            if (cell < 0) break;
+        }
+        
+        board_set_wall(board, board_index_row(board, cell),
+                       board_index_col(board, cell));
+        if (stats) stats->repairs++;
+        count = puzzle_count_solutions_witness(board, 2, witness, &length, stats);
+    }
+    
+    if (stats) {
+        stats->phase_seconds[STATS_PHASE_UNIQUENESS] += search_stats_now() - start;
+    }
+    return count;
+}
+
 Board *generate_unique_puzzle(
     int rows,
     int cols,
@@ -21,6 +90,21 @@ Board *generate_unique_puzzle(
     float wall_ratio,
     unsigned int seed,
     int max_attempts
+) {
+    return generate_unique_puzzle_repair(rows, cols, path_ratio, wall_ratio,
+                                         seed, max_attempts,
+                                         GENERATOR_DEFAULT_REPAIR_BUDGET);
+}
+
+static Board *generate_unique(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int repair_budget,
+    SearchStats *stats
 ) {
     /* Validate parameters */
     if (rows < 5 || cols < 5) {
@@ -35,19 +119,32 @@ Board *generate_unique_puzzle(
         return NULL;
     }
     
+    /* Witness buffer, big enough for any path on this board size */
+    int *witness = (int *)malloc((size_t)(rows + 2 * BOARD_PADDING) *
+                                 (cols + 2 * BOARD_PADDING) * sizeof(int));
+    if (!witness) {
+        return NULL;
+    }
+    if (stats) {
+        search_stats_alloc(stats, 1, (size_t)(rows + 2 * BOARD_PADDING) *
+                                     (cols + 2 * BOARD_PADDING) * sizeof(int));
+    }
+    
     /* Generation loop with uniqueness validation */
     int attempt = 0;
     unsigned int current_seed = seed;
     
     while (max_attempts == 0 || attempt < max_attempts) {
         attempt++;
+        if (stats) stats->attempts++;
         
         /* Generate candidate puzzle
          * 
          * Note: We use a different seed for each attempt to ensure variety.
          * Simply incrementing seed ensures deterministic retry sequence.
          */
-        Board *candidate = generate_puzzle(rows, cols, path_ratio, wall_ratio, current_seed);
+        Board *candidate = generate_puzzle_stats(rows, cols, path_ratio, wall_ratio,
+                                                 current_seed, stats);
         
         if (!candidate) {
             /* Generation failed - try next seed */
@@ -61,12 +158,18 @@ Board *generate_unique_puzzle(
          * We only need to distinguish:
          *   0 solutions  -> broken (should never happen with path-first)
          *   1 solution   -> PERFECT (this is what we want)
-         *   2+ solutions -> ambiguous (reject)
+         *   2+ solutions -> ambiguous (repair, then reject)
          * 
-         * Stopping at 2 means we don't waste time finding ALL solutions
-         * when we only need to know "is it unique or not".
+         * An ambiguous candidate is usually one wall away from unique:
+         * the second solution found tells us exactly where to put it.
          */
-        int solution_count = puzzle_count_solutions(candidate, 2);
+        int solution_count = repair_until_unique(candidate, witness, repair_budget, stats);
+        
+        if (solution_count < 0) {
+            /* Node budget spent: no later candidate could be checked */
+            board_free(candidate);
+            break;
+        }
         
         if (solution_count == 0) {
             /* This should NEVER happen with path-first generation
@@ -75,6 +178,7 @@ Board *generate_unique_puzzle(
             #ifdef DEBUG
             fprintf(stderr, "Warning: Generated unsolvable puzzle (seed: %u)\n", current_seed);
             #endif
+            if (stats) stats->unsolvable++;
             board_free(candidate);
             current_seed++;
             continue;
@@ -82,19 +186,20 @@ Board *generate_unique_puzzle(
         
         if (solution_count == 1) {
             /* SUCCESS: Found a puzzle with unique solution */
+            free(witness);
             return candidate;
         }
         
-        /* solution_count >= 2
+        /* solution_count >= 2 after the repair budget ran out
          * Puzzle has multiple solutions - reject and try again
-         * 
-         * This happens when random walls create alternative paths
-         * around the generated solution path.
          */
+        if (stats) stats->ambiguous++;
         board_free(candidate);
         current_seed++;
     }
     
+    free(witness);
+    
     /* Max attempts exceeded - no unique puzzle found
      * 
      * This can happen with very restrictive parameters
@@ -103,24 +208,18 @@ Board *generate_unique_puzzle(
     return NULL;
 }
 
-/* ============================================================================
- * STATISTICS AND DEBUGGING (Optional)
- * ============================================================================ */
-
-#ifdef GENERATOR_STATS
-
-/*
- * Extended version that tracks generation statistics
- * Useful for tuning parameters and understanding generation quality
- */
-
-typedef struct {
-    int total_attempts;
-    int unsolvable_count;    /* Should always be 0 with path-first */
-    int multiple_solutions_count;
-    int unique_found;
-    unsigned int final_seed;
-} GenerationStats;
+Board *generate_unique_puzzle_repair(
+    int rows,
+    int cols,
+    float path_ratio,
+    float wall_ratio,
+    unsigned int seed,
+    int max_attempts,
+    int repair_budget
+) {
+    return generate_unique(rows, cols, path_ratio, wall_ratio, seed,
+                           max_attempts, repair_budget, NULL);
+}
 
 Board *generate_unique_puzzle_stats(
     int rows,
@@ -129,54 +228,173 @@ Board *generate_unique_puzzle_stats(
     float wall_ratio,
     unsigned int seed,
     int max_attempts,
-    GenerationStats *stats
+    SearchStats *stats
 ) {
-    if (stats) {
-        stats->total_attempts = 0;
-        stats->unsolvable_count = 0;
-        stats->multiple_solutions_count = 0;
-        stats->unique_found = 0;
-        stats->final_seed = seed;
+    return generate_unique(rows, cols, path_ratio, wall_ratio, seed,
+                           max_attempts, GENERATOR_DEFAULT_REPAIR_BUDGET, stats);
+}
+
+/* ============================================================================
+ * BATCH GENERATION
+ * ============================================================================ */
+
+unsigned int generate_batch_seed(unsigned int base_seed, int index) {
+    /* One splitmix64-seeded draw per (base_seed, index): neighboring
+     * indices get unrelated seeds, so their retry sequences do not overlap */
+    Rng rng;
+    rng_seed(&rng, (uint64_t)base_seed << 32 | (uint32_t)index);
+    return (unsigned int)(rng_next(&rng) >> 32);
+}
+
+/*
+ * Slots still to generate: slots[0..count) in out, each from seed
+ * generate_batch_seed(base_seed, slot + round * stride)
+ */
+typedef struct {
+    const int *slots;
+    int count;
+    int round;
+    int stride;
+    const GeneratorParams *params;
+    unsigned int base_seed;
+    Board **out;
+    atomic_int next_slot;
+} BatchJob;
+
+static void *batch_worker_main(void *arg) {
+    BatchJob *job = (BatchJob *)arg;
+    const GeneratorParams *p = job->params;
+    
+    for (;;) {
+        int next = atomic_fetch_add(&job->next_slot, 1);
+        if (next >= job->count) break;
+        
+        /* Wraps harmlessly for huge batches: it only picks a seed */
+        int slot = job->slots[next];
+        int index = (int)((unsigned)slot + (unsigned)job->round * (unsigned)job->stride);
+        job->out[slot] = generate_unique_puzzle(
+            p->rows, p->cols, p->path_ratio, p->wall_ratio,
+            generate_batch_seed(job->base_seed, index), p->max_attempts
+        );
     }
     
-    int attempt = 0;
-    unsigned int current_seed = seed;
+    return NULL;
+}
+
+static void run_batch_job(BatchJob *job, int threads) {
+    atomic_init(&job->next_slot, 0);
     
-    while (max_attempts == 0 || attempt < max_attempts) {
-        attempt++;
-        if (stats) stats->total_attempts = attempt;
-        
-        Board *candidate = generate_puzzle(rows, cols, path_ratio, wall_ratio, current_seed);
-        if (!candidate) {
-            current_seed++;
-            continue;
-        }
-        
-        int solution_count = puzzle_count_solutions(candidate, 2);
-        
-        if (solution_count == 0) {
-            if (stats) stats->unsolvable_count++;
-            board_free(candidate);
-            current_seed++;
-            continue;
+    if (threads > job->count) {
+        threads = job->count;
+    }
+    
+    /* The calling thread works too; if a thread fails to start, the
+     * remaining workers simply claim its slots */
+    pthread_t *workers = NULL;
+    bool *started = NULL;
+    if (threads > 1) {
+        workers = (pthread_t *)calloc(threads, sizeof(pthread_t));
+        started = (bool *)calloc(threads, sizeof(bool));
+        if (workers && started) {
+            for (int t = 1; t < threads; t++) {
+                started[t] = pthread_create(&workers[t], NULL,
+                                            batch_worker_main, job) == 0;
+            }
         }
-        
-        if (solution_count >= 2) {
-            if (stats) stats->multiple_solutions_count++;
-            board_free(candidate);
-            current_seed++;
-            continue;
+    }
+    
+    batch_worker_main(job);
+    
+    if (workers && started) {
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) pthread_join(workers[t], NULL);
         }
+    }
+    free(started);
+    free(workers);
+}
+
+static int count_generated(int count, Board *out[]) {
+    int generated = 0;
+    for (int i = 0; i < count; i++) {
+        if (out[i]) generated++;
+    }
+    return generated;
+}
+
+int generate_unique_puzzle_batch(
+    int count,
+    const GeneratorParams *params,
+    unsigned int base_seed,
+    int threads,
+    Board *out[]
+) {
+    return generate_distinct_puzzle_batch(count, params, base_seed, threads,
+                                          out, NULL, 0);
+}
+
+int generate_distinct_puzzle_batch(
+    int count,
+    const GeneratorParams *params,
+    unsigned int base_seed,
+    int threads,
+    Board *out[],
+    FingerprintSet *seen,
+    int max_rounds
+) {
+    if (count < 0 || !params || (count > 0 && !out) || (seen && max_rounds < 1)) {
+        return -1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        out[i] = NULL;
+    }
+    
+    int *slots = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!slots) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        slots[i] = i;
+    }
+    
+    BatchJob job;
+    job.slots = slots;
+    job.count = count;
+    job.stride = count;
+    job.params = params;
+    job.base_seed = base_seed;
+    job.out = out;
+    
+    for (job.round = 0; job.count > 0; job.round++) {
+        run_batch_job(&job, threads);
+        if (!seen) break;
         
-        /* Found unique solution */
-        if (stats) {
-            stats->unique_found = 1;
-            stats->final_seed = current_seed;
+        /* Check in slot order, so the outcome does not depend on which
+         * worker finished first; duplicates go again with fresh seeds */
+        int pending = 0;
+        for (int k = 0; k < job.count; k++) {
+            int slot = slots[k];
+            if (!out[slot]) continue;
+            int added = fingerprint_set_insert(seen, board_fingerprint(out[slot]));
+            if (added < 0) {
+                /* seen could not grow: fail the batch rather than hand
+                 * back fewer puzzles with no reason given */
+                for (int i = 0; i < count; i++) {
+                    board_free(out[i]);
+                    out[i] = NULL;
+                }
+                free(slots);
+                return -1;
+            }
+            if (added == 1) continue;
+            board_free(out[slot]);
+            out[slot] = NULL;
+            slots[pending++] = slot;
         }
-        return candidate;
+        job.count = job.round + 1 < max_rounds ? pending : 0;
     }
     
-    return NULL;
+    free(slots);
+    return count_generated(count, out);
 }
-
-#endif 
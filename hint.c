@@ -0,0 +1,143 @@
+/*
+ * hint.c - Hint Engine Implementation
+ *
+ * A hint follows a cached route, a witness path from
+ * puzzle_count_solutions_from_state(). The route stays good for as long
+ * as the player walks along it: they stand on one of its cells, heading
+ * for the same number the route does there, with exactly the cells
+ * visited that the route had visited by then. Anything else (a detour,
+ * an undo past where the route was found, another board) runs a new
+ * search from the current state.
+ *
+ * Both checks are lookups: route_step maps the player's cell to its
+ * place on the route, and route_hash holds the GameState visited_hash
+ * expected there, so a hint on the route costs O(1) on any board.
+ */
+
+#include "hint.h"
+#include "solver_count.h"
+#include <stdlib.h>
+
+struct HintCache {
+    const Board *board;  /* board the route was found on */
+    int capacity;        /* board_cell_count() the arrays hold */
+    int *route;          /* cells from where it was found to the end */
+    int *route_number;   /* number the route heads for on each cell */
+    int *route_step;     /* cell -> position in route, -1 off it */
+    uint64_t *route_hash;   /* visited_hash of a game at each position */
+    int route_length;
+};
+
+HintCache *hint_cache_create(void) {
+    return (HintCache *)calloc(1, sizeof(HintCache));
+}
+
+void hint_cache_free(HintCache *cache) {
+    if (!cache) return;
+    free(cache->route);
+    free(cache->route_number);
+    free(cache->route_step);
+    free(cache->route_hash);
+    free(cache);
+}
+
+/* Forget the route and size the arrays for board */
+static bool hint_cache_reset(HintCache *cache, const Board *board) {
+    int cells = board_cell_count(board);
+
+    if (cells > cache->capacity) {
+        free(cache->route);
+        free(cache->route_number);
+        free(cache->route_step);
+        free(cache->route_hash);
+        cache->route = (int *)malloc(cells * sizeof(int));
+        cache->route_number = (int *)malloc(cells * sizeof(int));
+        cache->route_step = (int *)malloc(cells * sizeof(int));
+        cache->route_hash = (uint64_t *)malloc(cells * sizeof(uint64_t));
+        if (!cache->route || !cache->route_number || !cache->route_step ||
+            !cache->route_hash) {
+            free(cache->route);
+            free(cache->route_number);
+            free(cache->route_step);
+            free(cache->route_hash);
+            cache->route = cache->route_number = cache->route_step = NULL;
+            cache->route_hash = NULL;
+            cache->capacity = 0;
+            cache->board = NULL;
+            return false;
+        }
+        cache->capacity = cells;
+        for (int i = 0; i < cells; i++) cache->route_step[i] = -1;
+    } else {
+        for (int k = 0; k < cache->route_length; k++) {
+            cache->route_step[cache->route[k]] = -1;
+        }
+    }
+
+    cache->board = board;
+    cache->route_length = 0;
+    return true;
+}
+
+/*
+ * Position of the player on the cached route, or -1 when the route no
+ * longer finishes state's game
+ */
+static int route_position(const HintCache *cache, const GameState *state) {
+    const Board *board = state->board;
+    if (cache->board != board || cache->route_length == 0) return -1;
+
+    int pos = board_index(board, state->player.row, state->player.col);
+    int k = cache->route_step[pos];
+    if (k < 0 || k + 1 >= cache->route_length) return -1;
+    if (cache->route_number[k] != state->player.next_number) return -1;
+
+    /* Same visited cells as the route there: the rest of it is still free
+     * (and, under full coverage, still covers every open cell left) */
+    if (cache->route_hash[k] != state->visited_hash) return -1;
+
+    return k;
+}
+
+/* Search from state and cache the route found; false when there is none */
+static bool hint_resolve(HintCache *cache, const GameState *state) {
+    const Board *board = state->board;
+    if (!hint_cache_reset(cache, board)) return false;
+
+    int length;
+    if (puzzle_count_solutions_from_state(state, 1, cache->route, &length, NULL) == 0) {
+        return false;
+    }
+
+    int number = state->player.next_number;
+    uint64_t hash = state->visited_hash;
+    for (int k = 0; k < length; k++) {
+        if (k > 0) {
+            if (board->cells[cache->route[k]].type == CELL_NUMBER) number++;
+            hash ^= board_cell_key(cache->route[k]);
+        }
+        cache->route_number[k] = number;
+        cache->route_hash[k] = hash;
+        cache->route_step[cache->route[k]] = k;
+    }
+    cache->route_length = length;
+    return true;
+}
+
+bool game_state_hint(const GameState *state, HintCache *cache, char *direction) {
+    if (!state || !cache || !direction) return false;
+
+    int k = route_position(cache, state);
+    if (k < 0) {
+        if (!hint_resolve(cache, state)) return false;
+        k = 0;
+    }
+
+    int step = cache->route[k + 1] - cache->route[k];
+    const int *delta = state->board->delta;
+    if (step == delta[BOARD_UP]) *direction = 'w';
+    else if (step == delta[BOARD_DOWN]) *direction = 's';
+    else if (step == delta[BOARD_LEFT]) *direction = 'a';
+    else *direction = 'd';
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * hint.h - Hint Engine
+ *
+ * Answers "can the player still win from here, and what is the next
+ * correct move?" for a game in progress, without replaying it.
+ *
+ * Usage:
+ *   HintCache *hints = hint_cache_create();
+ *   char key;
+ *   if (game_state_hint(game, hints, &key)) {
+ *       movement_try_move(game, key);
+ *   }
+ *   hint_cache_free(hints);
+ */
+
+#ifndef HINT_H
+#define HINT_H
+
+#include "engine.h"
+
+/*
+ * The route behind the last hint: one way to finish the game from where
+ * it was found. Reusable across games and boards, but the route is tied
+ * to the board's address: after changing a board, or freeing it while
+ * another may take its place, start over with a new cache.
+ */
+typedef struct HintCache HintCache;
+
+HintCache *hint_cache_create(void);
+void hint_cache_free(HintCache *cache);
+
+/*
+ * Next move toward a win from state
+ *
+ * Parameters:
+ *   state     - Game in progress (not modified)
+ *   cache     - Route kept between calls for state's board
+ *   direction - Receives the move as a movement_try_move() key
+ *               ('w', 's', 'a' or 'd')
+ *
+ * Returns:
+ *   true with *direction set, or false when the game is over (won, or
+ *   can no longer be won) or on allocation failure
+ *
+ * Performance:
+ *   While the player stays on the cached route a hint is O(1): the
+ *   player's cell is looked up on the route, and the game's
+ *   visited_hash is compared with the one the route expects there. Only
+ *   leaving the route triggers a new search, which resumes from the
+ *   player's cell with the pruned GRID counter (solver_count.h).
+ */
+bool game_state_hint(const GameState *state, HintCache *cache, char *direction);
+
+#endif /* HINT_H */
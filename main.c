@@ -1,19 +1,35 @@
 /*
  * main.c - Game Loop
  * Uses immutable Board + mutable GameState architecture
+ *
+ *   zip                  - Play in the terminal
+ *   zip --serve          - Batch service on stdin/stdout (service.h)
+ *   zip --serve PATH     - Batch service on a Unix socket at PATH
  */
 
 #include "engine.h"
+#include "service.h"
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Keys applied per frame at most; more typed-ahead keys wait a frame */
+#define KEY_BATCH_MAX 256
 
 void board_render(const Board *board, const GameState *game);
 void ui_show_invalid_move(void);
 void ui_show_undo_failed(void);
+void ui_show_redo_failed(void);
 void ui_show_win(void);
-char ui_get_input(void);
+int ui_read_keys(char *keys, int max);
+bool ui_raw_mode_enter(void);
+void ui_raw_mode_leave(void);
+void ui_release(void);
 
-int main(void) {
+static int play(void) {
     Board *board = create_puzzle();
     if (!board) {
         fprintf(stderr, "Failed to create puzzle\n");
@@ -27,9 +43,9 @@ int main(void) {
         return 1;
     }
     
-    UndoStack *undo_stack = undo_stack_create();
-    if (!undo_stack) {
-        fprintf(stderr, "Failed to create undo stack\n");
+    MoveJournal *journal = move_journal_create();
+    if (!journal) {
+        fprintf(stderr, "Failed to create move journal\n");
         game_state_free(game);
         board_free(board);
         return 1;
@@ -38,6 +54,10 @@ int main(void) {
     int running = 1;
     int invalid_move = 0;
     int undo_failed = 0;
+    int redo_failed = 0;
+    char keys[KEY_BATCH_MAX];
+    
+    ui_raw_mode_enter();
     
     while (running) {
         board_render(board, game);
@@ -50,49 +70,82 @@ int main(void) {
             ui_show_undo_failed();
             undo_failed = 0;
         }
+        if (redo_failed) {
+            ui_show_redo_failed();
+            redo_failed = 0;
+        }
         
         if (game_state_check_win(game)) {
             ui_show_win();
-            ui_get_input();
+            ui_read_keys(keys, KEY_BATCH_MAX);
             running = 0;
             continue;
         }
         
-        char command = ui_get_input();
-        
-        if (command == 'q' || command == 'Q') {
-            running = 0;
-        } else if (command == 'u' || command == 'U') {
-            if (!undo_stack_pop(undo_stack, game)) {
-                undo_failed = 1;
-            }
-        } else if (command == 'w' || command == 'W' ||
-                   command == 'a' || command == 'A' ||
-                   command == 's' || command == 'S' ||
-                   command == 'd' || command == 'D') {
-            int new_row = game->player.row;
-            int new_col = game->player.col;
-            switch (command) {
-                case 'w': case 'W': new_row--; break;
-                case 's': case 'S': new_row++; break;
-                case 'a': case 'A': new_col--; break;
-                case 'd': case 'D': new_col++; break;
-            }
-            
-            undo_stack_push(undo_stack, game, new_row, new_col);
+        /* Apply everything typed since the last frame, then draw once */
+        int count = ui_read_keys(keys, KEY_BATCH_MAX);
+        for (int i = 0; i < count && running; i++) {
+            char command = keys[i];
             
-            if (!movement_try_move(game, command)) {
-                undo_stack_pop(undo_stack, game);  
+            if (command == 'q' || command == 'Q') {
+                running = 0;
+            } else if (command == 'u' || command == 'U') {
+                if (!move_journal_undo(journal, game)) {
+                    undo_failed = 1;
+                }
+            } else if (command == 'r' || command == 'R') {
+                if (!move_journal_redo(journal, game)) {
+                    redo_failed = 1;
+                }
+            } else if (!move_journal_try_move(journal, game, command)) {
                 invalid_move = 1;
             }
-        } else {
-            invalid_move = 1;
+            
+            /* Keys past the winning move are dropped */
+            if (game_state_check_win(game)) break;
         }
     }
     
-    undo_stack_free(undo_stack);
+    ui_raw_mode_leave();
+    ui_release();
+    move_journal_free(journal);
     game_state_free(game);
     board_free(board);
     
     return 0;
 }
+
+static int serve(const char *socket_path) {
+    Service *service = service_create();
+    if (!service) {
+        fprintf(stderr, "Failed to create service\n");
+        return 1;
+    }
+    
+    /* A client hanging up shows up as a failed write, not a signal */
+    signal(SIGPIPE, SIG_IGN);
+    
+    bool ok;
+    if (socket_path) {
+        ok = service_listen(service, socket_path);
+        if (!ok) {
+            fprintf(stderr, "Failed to listen on %s: %s\n", socket_path, strerror(errno));
+        }
+    } else {
+        ok = service_run(service, STDIN_FILENO, STDOUT_FILENO);
+    }
+    
+    service_free(service);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        return serve(argc > 2 ? argv[2] : NULL);
+    }
+    if (argc > 1) {
+        fprintf(stderr, "usage: %s [--serve [SOCKET_PATH]]\n", argv[0]);
+        return 2;
+    }
+    return play();
+}
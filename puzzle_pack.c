@@ -0,0 +1,401 @@
+/*
+ * puzzle_pack.c - Binary Puzzle Pack Writer and Reader
+ *
+ * Integers are assembled byte by byte, so packs are the same on every
+ * platform and the mapping needs no alignment.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "puzzle_pack.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PACK_HEADER_BYTES 24
+#define PACK_RECORD_BYTES 16
+
+static const char pack_magic[4] = {'Z', 'P', 'A', 'K'};
+
+/* ============================================================================
+ * ENCODING
+ * ============================================================================ */
+
+static void put_u16(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+static void put_u64(unsigned char *p, uint64_t v) {
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint32_t get_u16(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return get_u16(p) | get_u16(p + 2) << 16;
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    return get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+/* Bytes holding count 2-bit fields */
+static size_t packed_bytes(size_t count) {
+    return (count + 3) / 4;
+}
+
+static unsigned get_2bit(const unsigned char *p, size_t k) {
+    return (p[k / 4] >> (2 * (k % 4))) & 3;
+}
+
+static void set_2bit(unsigned char *p, size_t k, unsigned v) {
+    p[k / 4] |= (unsigned char)(v << (2 * (k % 4)));
+}
+
+static const char move_keys[] = {'w', 's', 'a', 'd'};
+
+static int move_direction(char key) {
+    for (int dir = 0; dir < 4; dir++) {
+        if (key == move_keys[dir] || key == move_keys[dir] - 'a' + 'A') return dir;
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * WRITER
+ * ============================================================================ */
+
+struct PackWriter {
+    FILE *file;
+    uint64_t offset;        /* bytes written so far */
+    uint64_t *offsets;      /* record offset per puzzle */
+    int count;
+    int capacity;
+    int max_height;
+    int max_width;
+    unsigned char *record;  /* scratch for the record being encoded */
+    size_t record_capacity;
+    bool failed;
+};
+
+PackWriter *pack_writer_open(const char *path) {
+    PackWriter *writer = (PackWriter *)calloc(1, sizeof(PackWriter));
+    if (!writer) return NULL;
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        free(writer);
+        return NULL;
+    }
+
+    /* The header is written for real by pack_writer_close() */
+    unsigned char header[PACK_HEADER_BYTES] = {0};
+    writer->failed = fwrite(header, sizeof(header), 1, writer->file) != 1;
+    writer->offset = PACK_HEADER_BYTES;
+    return writer;
+}
+
+static bool writer_reserve(PackWriter *writer, size_t record_bytes) {
+    if (writer->count == writer->capacity) {
+        int capacity = writer->capacity ? 2 * writer->capacity : 256;
+        uint64_t *offsets = (uint64_t *)realloc(writer->offsets,
+                                                capacity * sizeof(uint64_t));
+        if (!offsets) return false;
+        writer->offsets = offsets;
+        writer->capacity = capacity;
+    }
+
+    if (record_bytes > writer->record_capacity) {
+        unsigned char *record = (unsigned char *)realloc(writer->record, record_bytes);
+        if (!record) return false;
+        writer->record = record;
+        writer->record_capacity = record_bytes;
+    }
+    return true;
+}
+
+bool pack_writer_add(PackWriter *writer, const Board *board,
+                     const char *solution, int move_count) {
+    if (!writer || writer->failed || !board) return false;
+
+    size_t cells = (size_t)board->height * board->width;
+    if (board->height <= 0 || board->width <= 0) {
+        errno = EINVAL;
+        return false;
+    }
+    if (board->height > PACK_MAX_SIDE || board->width > PACK_MAX_SIDE ||
+        cells > PACK_MAX_CELLS || board->max_number > PACK_MAX_NUMBER) {
+        errno = EOVERFLOW;
+        return false;
+    }
+    if (!solution) move_count = 0;
+    if (move_count < 0 || (size_t)move_count > cells) {
+        errno = EINVAL;
+        return false;
+    }
+
+    int numbers = 0;
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            const Cell *cell = board_cell(board, i, j);
+            if (cell->type != CELL_NUMBER) continue;
+            if (cell->number < 0 || cell->number > PACK_MAX_NUMBER) {
+                errno = EOVERFLOW;
+                return false;
+            }
+            numbers++;
+        }
+    }
+
+    size_t types_bytes = packed_bytes(cells);
+    size_t record_bytes = PACK_RECORD_BYTES + types_bytes + 2 * (size_t)numbers +
+                          packed_bytes(move_count);
+    if (!writer_reserve(writer, record_bytes)) return false;
+
+    unsigned char *record = writer->record;
+    memset(record, 0, record_bytes);
+    put_u16(record, board->height);
+    put_u16(record + 2, board->width);
+    record[4] = (unsigned char)board->rules;
+    record[5] = solution ? PACK_HAS_SOLUTION : 0;
+    put_u32(record + 8, numbers);
+    put_u32(record + 12, move_count);
+
+    unsigned char *types = record + PACK_RECORD_BYTES;
+    unsigned char *number_table = types + types_bytes;
+    size_t k = 0;
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++, k++) {
+            const Cell *cell = board_cell(board, i, j);
+            set_2bit(types, k, cell->type);
+            if (cell->type == CELL_NUMBER) {
+                put_u16(number_table, cell->number);
+                number_table += 2;
+            }
+        }
+    }
+
+    for (int m = 0; m < move_count; m++) {
+        int dir = move_direction(solution[m]);
+        if (dir < 0) {
+            errno = EINVAL;
+            return false;
+        }
+        set_2bit(number_table, m, dir);
+    }
+
+    if (fwrite(record, record_bytes, 1, writer->file) != 1) {
+        writer->failed = true;
+        return false;
+    }
+
+    writer->offsets[writer->count++] = writer->offset;
+    writer->offset += record_bytes;
+    if (board->height > writer->max_height) writer->max_height = board->height;
+    if (board->width > writer->max_width) writer->max_width = board->width;
+    return true;
+}
+
+bool pack_writer_close(PackWriter *writer) {
+    if (!writer) return false;
+
+    bool ok = !writer->failed;
+    uint64_t index_offset = writer->offset;
+    unsigned char entry[8];
+    for (int i = 0; ok && i < writer->count; i++) {
+        put_u64(entry, writer->offsets[i]);
+        ok = fwrite(entry, sizeof(entry), 1, writer->file) == 1;
+    }
+
+    unsigned char header[PACK_HEADER_BYTES];
+    memcpy(header, pack_magic, sizeof(pack_magic));
+    put_u32(header + 4, PACK_VERSION);
+    put_u32(header + 8, writer->count);
+    put_u16(header + 12, writer->max_height);
+    put_u16(header + 14, writer->max_width);
+    put_u64(header + 16, index_offset);
+    ok = ok && fseek(writer->file, 0, SEEK_SET) == 0 &&
+         fwrite(header, sizeof(header), 1, writer->file) == 1;
+
+    ok = fclose(writer->file) == 0 && ok;
+    free(writer->offsets);
+    free(writer->record);
+    free(writer);
+    return ok;
+}
+
+/* ============================================================================
+ * READER
+ * ============================================================================ */
+
+struct PuzzlePack {
+    const unsigned char *data;  /* the whole file, mapped read-only */
+    size_t size;
+    int count;
+    int max_height;
+    int max_width;
+    const unsigned char *index;
+    uint64_t index_offset;
+};
+
+PuzzlePack *puzzle_pack_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < PACK_HEADER_BYTES) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    const unsigned char *bytes = (const unsigned char *)data;
+    uint32_t count = get_u32(bytes + 8);
+    uint64_t index_offset = get_u64(bytes + 16);
+    if (memcmp(bytes, pack_magic, sizeof(pack_magic)) != 0 ||
+        get_u32(bytes + 4) != PACK_VERSION || count > INT32_MAX ||
+        index_offset < PACK_HEADER_BYTES || index_offset > size ||
+        (size - index_offset) / 8 < count) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    PuzzlePack *pack = (PuzzlePack *)malloc(sizeof(PuzzlePack));
+    if (!pack) {
+        munmap(data, size);
+        return NULL;
+    }
+    pack->data = bytes;
+    pack->size = size;
+    pack->count = (int)count;
+    pack->max_height = (int)get_u16(bytes + 12);
+    pack->max_width = (int)get_u16(bytes + 14);
+    pack->index = bytes + index_offset;
+    pack->index_offset = index_offset;
+    return pack;
+}
+
+void puzzle_pack_close(PuzzlePack *pack) {
+    if (!pack) return;
+    munmap((void *)pack->data, pack->size);
+    free(pack);
+}
+
+int puzzle_pack_count(const PuzzlePack *pack) {
+    return pack ? pack->count : 0;
+}
+
+Board *puzzle_pack_board_create(const PuzzlePack *pack) {
+    if (!pack) return NULL;
+    int height = pack->max_height > 0 ? pack->max_height : 1;
+    int width = pack->max_width > 0 ? pack->max_width : 1;
+    return board_create(height, width);
+}
+
+/*
+ * A checked record: its sections, each known to lie inside the record
+ */
+typedef struct {
+    int height;
+    int width;
+    int rules;
+    int flags;
+    uint32_t numbers;
+    uint32_t moves;
+    const unsigned char *types;
+    const unsigned char *number_table;
+    const unsigned char *solution;
+} PackRecord;
+
+static bool pack_record(const PuzzlePack *pack, int index, PackRecord *record) {
+    if (!pack || index < 0 || index >= pack->count) return false;
+
+    uint64_t start = get_u64(pack->index + (size_t)index * 8);
+    uint64_t end = index + 1 < pack->count ?
+                   get_u64(pack->index + (size_t)(index + 1) * 8) : pack->index_offset;
+    if (start < PACK_HEADER_BYTES || end > pack->index_offset ||
+        start > end || end - start < PACK_RECORD_BYTES) return false;
+
+    const unsigned char *p = pack->data + start;
+    record->height = (int)get_u16(p);
+    record->width = (int)get_u16(p + 2);
+    record->rules = p[4];
+    record->flags = p[5];
+    record->numbers = get_u32(p + 8);
+    record->moves = get_u32(p + 12);
+
+    uint64_t cells = (uint64_t)record->height * record->width;
+    if (record->height == 0 || record->width == 0 || cells > PACK_MAX_CELLS ||
+        record->numbers > cells || record->moves > cells ||
+        record->rules > RULES_FULL_COVERAGE) return false;
+
+    uint64_t types_bytes = packed_bytes(cells);
+    uint64_t need = PACK_RECORD_BYTES + types_bytes + 2 * (uint64_t)record->numbers +
+                    packed_bytes(record->moves);
+    if (end - start < need) return false;
+
+    record->types = p + PACK_RECORD_BYTES;
+    record->number_table = record->types + types_bytes;
+    record->solution = record->number_table + 2 * (size_t)record->numbers;
+    return true;
+}
+
+bool puzzle_pack_load(const PuzzlePack *pack, int index, Board *board) {
+    PackRecord record;
+    if (!board || !pack_record(pack, index, &record)) return false;
+    if (!board_reset(board, record.height, record.width)) return false;
+    board_set_rules(board, (BoardRules)record.rules);
+
+    const unsigned char *number = record.number_table;
+    const unsigned char *numbers_end = number + 2 * (size_t)record.numbers;
+    size_t k = 0;
+    for (int i = 0; i < record.height; i++) {
+        for (int j = 0; j < record.width; j++, k++) {
+            switch (get_2bit(record.types, k)) {
+                case CELL_EMPTY:
+                    break;
+                case CELL_WALL:
+                    board_set_wall(board, i, j);
+                    break;
+                case CELL_NUMBER:
+                    if (number == numbers_end) return false;
+                    board_set_number(board, i, j, (int)get_u16(number));
+                    number += 2;
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+    return number == numbers_end;
+}
+
+int puzzle_pack_solution(const PuzzlePack *pack, int index, char *moves) {
+    PackRecord record;
+    if (!moves || !pack_record(pack, index, &record) ||
+        !(record.flags & PACK_HAS_SOLUTION)) return -1;
+
+    for (uint32_t m = 0; m < record.moves; m++) {
+        moves[m] = move_keys[get_2bit(record.solution, m)];
+    }
+    return (int)record.moves;
+}
@@ -0,0 +1,126 @@
+/*
+ * puzzle_pack.h - Binary Puzzle Packs
+ *
+ * Many puzzles in one file, each readable by index without touching the
+ * others. The reader maps the file and decodes a puzzle straight from
+ * the mapping into a Board the caller reuses, so opening a pack costs
+ * the same for a hundred puzzles or millions, and serving one allocates
+ * nothing.
+ *
+ * Format (version 1, all integers little-endian):
+ *
+ *   Header, 24 bytes
+ *     0  "ZPAK"
+ *     4  u32 version
+ *     8  u32 puzzle count
+ *    12  u16 largest height, u16 largest width
+ *    16  u64 index offset
+ *
+ *   Records, one per puzzle
+ *     0  u16 height, u16 width
+ *     4  u8 rules (BoardRules), u8 flags (PACK_HAS_SOLUTION), u16 zero
+ *     8  u32 number cells, u32 solution moves (0 without a solution)
+ *    16  cell types, 2 bits per cell in row-major order (CellType),
+ *        four cells per byte starting at the low bits
+ *        numbers of the number cells, u16 each, row-major order
+ *        solution moves, 2 bits each (BOARD_UP..BOARD_RIGHT), packed
+ *        like the cell types
+ *
+ *   Index: one u64 record offset per puzzle. A record ends where the
+ *   next one (or the index) starts.
+ *
+ * Usage:
+ *   PackWriter *writer = pack_writer_open("daily.zpak");
+ *   pack_writer_add(writer, board, NULL, 0);
+ *   pack_writer_close(writer);
+ *
+ *   PuzzlePack *pack = puzzle_pack_open("daily.zpak");
+ *   Board *view = puzzle_pack_board_create(pack);
+ *   if (puzzle_pack_load(pack, 42, view)) ... play view ...
+ *   board_free(view);
+ *   puzzle_pack_close(pack);
+ */
+
+#ifndef PUZZLE_PACK_H
+#define PUZZLE_PACK_H
+
+#include "engine.h"
+
+#define PACK_VERSION 1
+#define PACK_HAS_SOLUTION 0x01
+
+/*
+ * Largest puzzle a pack holds (4096x4096 fits). Sides and numbers are
+ * u16 on disk. The cell cap keeps a padded board's cell count well
+ * inside an int, and stops a corrupt record from asking for a huge board.
+ */
+#define PACK_MAX_SIDE 0xFFFF
+#define PACK_MAX_NUMBER 0xFFFF
+#define PACK_MAX_CELLS (1 << 24)
+
+/* ========== WRITING ========== */
+
+typedef struct PackWriter PackWriter;
+
+/* Create (or truncate) path for writing; NULL when it cannot be opened */
+PackWriter *pack_writer_open(const char *path);
+
+/*
+ * Append a puzzle
+ *
+ * Parameters:
+ *   board      - Puzzle to store, within PACK_MAX_SIDE, PACK_MAX_CELLS
+ *                and PACK_MAX_NUMBER
+ *   solution   - Optional solution as movement_try_move() keys from
+ *                number 1 (NULL stores none)
+ *   move_count - Number of keys in solution
+ *
+ * Returns:
+ *   false when the board or solution cannot be stored or on I/O error.
+ *   errno is EOVERFLOW for a board beyond the limits above and EINVAL
+ *   for a bad solution; the writer stays usable after either.
+ */
+bool pack_writer_add(PackWriter *writer, const Board *board,
+                     const char *solution, int move_count);
+
+/*
+ * Write the index and header, then close and free the writer
+ *
+ * Returns false when anything failed since pack_writer_open(); the file
+ * is then not a valid pack.
+ */
+bool pack_writer_close(PackWriter *writer);
+
+/* ========== READING ========== */
+
+typedef struct PuzzlePack PuzzlePack;
+
+/*
+ * Map a pack read-only; NULL when it is missing, not a pack or of
+ * another version. Records are checked when they are loaded.
+ */
+PuzzlePack *puzzle_pack_open(const char *path);
+void puzzle_pack_close(PuzzlePack *pack);
+
+int puzzle_pack_count(const PuzzlePack *pack);
+
+/* A Board large enough to load any puzzle of pack into (caller frees) */
+Board *puzzle_pack_board_create(const PuzzlePack *pack);
+
+/*
+ * Decode puzzle index into board, replacing what it held (board_reset())
+ *
+ * Returns false for an index out of range, a board too small or a
+ * corrupt record; board then holds no usable puzzle.
+ */
+bool puzzle_pack_load(const PuzzlePack *pack, int index, Board *board);
+
+/*
+ * Stored solution of puzzle index as movement_try_move() keys
+ *
+ * moves needs room for height * width keys. Returns the number of moves,
+ * or -1 when the puzzle has no solution stored or on a corrupt record.
+ */
+int puzzle_pack_solution(const PuzzlePack *pack, int index, char *moves);
+
+#endif /* PUZZLE_PACK_H */
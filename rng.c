@@ -0,0 +1,66 @@
+/*
+ * rng.c - Portable Reentrant Random Number Generator Implementation
+ * 
+ * xoshiro256** and splitmix64 by David Blackman and Sebastiano Vigna
+ * (public domain reference versions), and Lemire's multiply-shift
+ * method for unbiased bounded draws.
+ */
+
+#include "rng.h"
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Rng *rng, uint64_t seed) {
+    /* splitmix64 never yields an all-zero xoshiro state */
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    
+    return result;
+}
+
+uint32_t rng_below(Rng *rng, uint32_t n) {
+    /* Map a 32-bit draw onto 0..n-1 by multiplication, rejecting the few
+     * low products that would make some values more likely */
+    uint64_t m = (uint64_t)(uint32_t)(rng_next(rng) >> 32) * n;
+    uint32_t low = (uint32_t)m;
+    
+    if (low < n) {
+        uint32_t threshold = (uint32_t)-n % n;
+        while (low < threshold) {
+            m = (uint64_t)(uint32_t)(rng_next(rng) >> 32) * n;
+            low = (uint32_t)m;
+        }
+    }
+    
+    return (uint32_t)(m >> 32);
+}
+
+bool rng_chance(Rng *rng, float p) {
+    /* 24 random bits against p scaled by 2^24: both sides are exact in
+     * single precision, so the outcome does not depend on the FPU */
+    uint32_t bits = (uint32_t)(rng_next(rng) >> 40);
+    return (float)bits < p * 16777216.0f;
+}
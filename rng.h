@@ -0,0 +1,40 @@
+/*
+ * rng.h - Portable Reentrant Random Number Generator
+ * 
+ * xoshiro256** with splitmix64 seeding. All state lives in an Rng value
+ * owned by the caller, so generators on different threads never interact,
+ * and every draw is defined with fixed-width integer arithmetic, so a
+ * seed produces the same sequence on every platform and libc.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+/*
+ * Initialize from a seed (any value, including 0, is fine)
+ */
+void rng_seed(Rng *rng, uint64_t seed);
+
+/*
+ * Next raw 64-bit output
+ */
+uint64_t rng_next(Rng *rng);
+
+/*
+ * Uniform integer in 0..n-1 without modulo bias (n >= 1)
+ */
+uint32_t rng_below(Rng *rng, uint32_t n);
+
+/*
+ * True with probability p (p <= 0 never, p >= 1 always)
+ */
+bool rng_chance(Rng *rng, float p);
+
+#endif /* RNG_H */
@@ -0,0 +1,66 @@
+/*
+ * search_stats.c - Runtime Search Statistics Implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "search_stats.h"
+#include <string.h>
+#include <time.h>
+
+void search_stats_reset(SearchStats *stats) {
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+void search_stats_merge(SearchStats *into, const SearchStats *from) {
+    into->nodes += from->nodes;
+    into->backtracks += from->backtracks;
+    if (from->max_depth > into->max_depth) {
+        into->max_depth = from->max_depth;
+    }
+    for (int d = 0; d < SEARCH_STATS_MAX_DEPTH; d++) {
+        into->depth_nodes[d] += from->depth_nodes[d];
+    }
+    for (int r = 0; r < PRUNE_REASON_COUNT; r++) {
+        into->prunes[r] += from->prunes[r];
+    }
+    into->table_probes += from->table_probes;
+    into->table_hits += from->table_hits;
+
+    into->allocations += from->allocations;
+    into->bytes_allocated += from->bytes_allocated;
+
+    for (int p = 0; p < STATS_PHASE_COUNT; p++) {
+        into->phase_seconds[p] += from->phase_seconds[p];
+    }
+    into->attempts += from->attempts;
+    into->unsolvable += from->unsolvable;
+    into->ambiguous += from->ambiguous;
+    into->repairs += from->repairs;
+}
+
+double search_stats_branching(const SearchStats *stats, int depth) {
+    /* Every node at depth + 1 is a child of one at depth; the last
+     * bucket mixes depths, so it has no meaningful ratio */
+    if (depth < 0 || depth >= SEARCH_STATS_MAX_DEPTH - 1 ||
+        stats->depth_nodes[depth] == 0) {
+        return 0.0;
+    }
+    return (double)stats->depth_nodes[depth + 1] / stats->depth_nodes[depth];
+}
+
+long search_stats_prunes(const SearchStats *stats) {
+    long total = 0;
+    for (int r = 0; r < PRUNE_REASON_COUNT; r++) {
+        total += stats->prunes[r];
+    }
+    return total;
+}
+
+double search_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
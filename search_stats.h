@@ -0,0 +1,144 @@
+/*
+ * search_stats.h - Runtime Search Statistics
+ *
+ * One struct that solvers and the generator fill in when the caller hands
+ * them one. Every entry point that takes a SearchStats * accepts NULL, in
+ * which case nothing is recorded and no clock is read; the hot loops only
+ * pay for a pointer test.
+ *
+ * Counters accumulate across calls, so one struct can cover a whole
+ * generation run or a batch of solves. Start from search_stats_reset().
+ *
+ * Usage:
+ *   SearchStats stats;
+ *   search_stats_reset(&stats);
+ *   Board *puzzle = generate_unique_puzzle_stats(10, 10, 0.5f, 0.2f,
+ *                                                seed, 100, &stats);
+ *   printf("%ld nodes, %.3f ms counting\n", stats.nodes,
+ *          stats.phase_seconds[STATS_PHASE_UNIQUENESS] * 1e3);
+ */
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Why a branch was cut by pruning
+ *
+ *   PRUNE_NEXT_UNREACHABLE - The next number cannot be reached from the
+ *                            path head through blank cells
+ *   PRUNE_NUMBER_CUT_OFF   - Some later number cannot be reached at all
+ *   PRUNE_SEGMENT_BLOCKED  - Before searching: a segment k -> k+1 is not
+ *                            connected through blank cells
+ *
+ * Full coverage only (RULES_FULL_COVERAGE):
+ *   PRUNE_ISOLATED_CELL    - An unvisited cell has no free neighbor left
+ *   PRUNE_DEAD_END         - An unvisited cell other than the last
+ *                            number has only one (no way out)
+ *   PRUNE_PARITY           - Before searching: the checkerboard color
+ *                            counts rule out a covering path
+ *   PRUNE_REGION_SPLIT     - Some unvisited open cell is cut off
+ */
+typedef enum {
+    PRUNE_NEXT_UNREACHABLE,
+    PRUNE_NUMBER_CUT_OFF,
+    PRUNE_SEGMENT_BLOCKED,
+    PRUNE_ISOLATED_CELL,
+    PRUNE_DEAD_END,
+    PRUNE_PARITY,
+    PRUNE_REGION_SPLIT,
+    PRUNE_REASON_COUNT
+} PruneReason;
+
+/*
+ * Generator phases timed in phase_seconds
+ *
+ *   STATS_PHASE_PATH_DFS       - Random walk that lays out the path
+ *   STATS_PHASE_WALL_PLACEMENT - Walls on the cells off the path
+ *   STATS_PHASE_UNIQUENESS     - Solution counting and witness repair
+ */
+typedef enum {
+    STATS_PHASE_PATH_DFS,
+    STATS_PHASE_WALL_PLACEMENT,
+    STATS_PHASE_UNIQUENESS,
+    STATS_PHASE_COUNT
+} StatsPhase;
+
+/* Depths at or past the last bucket share it */
+#define SEARCH_STATS_MAX_DEPTH 1024
+
+typedef struct {
+    /* Solver search */
+    long nodes;             /* Cells entered and expanded */
+    long backtracks;        /* Expanded cells later left again */
+    int max_depth;          /* Longest path prefix expanded (start = 0) */
+    long depth_nodes[SEARCH_STATS_MAX_DEPTH];
+    long prunes[PRUNE_REASON_COUNT];
+    long table_probes;      /* Transposition table lookups */
+    long table_hits;        /* Subtrees answered from the table */
+
+    /* Memory */
+    long allocations;       /* Heap blocks taken for search state */
+    size_t bytes_allocated;
+
+    /* Generator */
+    double phase_seconds[STATS_PHASE_COUNT];
+    long attempts;          /* Candidate boards generated */
+    long unsolvable;        /* Candidates with no solution */
+    long ambiguous;         /* Candidates still ambiguous after repair */
+    long repairs;           /* Walls added by witness repair */
+
+    /* Budget set by the caller (0 = none): a serial count recording
+     * here gives up once nodes reaches node_limit and returns -1, and
+     * the generator then returns NULL. search_stats_reset() clears it,
+     * search_stats_merge() leaves it alone. */
+    long node_limit;
+} SearchStats;
+
+void search_stats_reset(SearchStats *stats);
+
+/*
+ * Add every counter of from to into (max_depth takes the larger)
+ */
+void search_stats_merge(SearchStats *into, const SearchStats *from);
+
+/*
+ * Average number of children expanded per node expanded at depth,
+ * or 0 when no node was expanded there
+ */
+double search_stats_branching(const SearchStats *stats, int depth);
+
+/*
+ * Sum of prunes over every reason
+ */
+long search_stats_prunes(const SearchStats *stats);
+
+/*
+ * Monotonic clock in seconds, for phase_seconds
+ */
+double search_stats_now(void);
+
+/* ============================================================================
+ * RECORDING (for solver and generator code; stats must not be NULL)
+ * ============================================================================ */
+
+static inline void search_stats_node(SearchStats *stats, int depth) {
+    stats->nodes++;
+    if (depth > stats->max_depth) stats->max_depth = depth;
+    if (depth >= SEARCH_STATS_MAX_DEPTH) depth = SEARCH_STATS_MAX_DEPTH - 1;
+    stats->depth_nodes[depth]++;
+}
+
+/* True once node_limit is set and nodes has reached it */
+static inline bool search_stats_spent(const SearchStats *stats) {
+    return stats->node_limit > 0 && stats->nodes >= stats->node_limit;
+}
+
+static inline void search_stats_alloc(SearchStats *stats, int blocks, size_t bytes) {
+    stats->allocations += blocks;
+    stats->bytes_allocated += bytes;
+}
+
+#endif /* SEARCH_STATS_H */
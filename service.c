@@ -0,0 +1,506 @@
+/*
+ * service.c - Headless Batch Service Implementation
+ *
+ * Requests are handled in place in the input buffer: a line is split
+ * into NUL-terminated tokens and parsed straight into the warm board.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "service.h"
+#include "engine.h"
+#include "generator_clues.h"
+#include "generator_unique.h"
+#include "search_stats.h"
+#include "solver_count.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVICE_MAX_LINE (1 << 20)
+#define SERVICE_READ_CHUNK 65536
+#define SERVICE_MAX_TOKENS 8
+
+/* GENERATE limits */
+#define SERVICE_MIN_SIDE 5
+#define SERVICE_MAX_SIDE 100
+#define SERVICE_MAX_ATTEMPTS 100
+
+/*
+ * Search nodes one COUNT or GENERATE may expand (SearchStats node_limit):
+ * SERVICE_MAX_NODES, or SERVICE_MAX_WORK / cells when that is fewer,
+ * since the reachability pruning makes a node cost more on big boards
+ */
+#define SERVICE_MAX_NODES 500000L
+#define SERVICE_MAX_WORK 400000000L
+
+/* Longest formatted cell: an int plus its separator */
+#define CELL_TEXT_MAX 12
+
+/* ============================================================================
+ * BUFFERS
+ * ============================================================================ */
+
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+static bool buffer_reserve(Buffer *buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) return true;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra) capacity *= 2;
+    char *data = (char *)realloc(buffer->data, capacity);
+    if (!data) return false;
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void buffer_printf(Buffer *buffer, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (n < 0 || !buffer_reserve(buffer, (size_t)n + 1)) return;
+
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, (size_t)n + 1, format, args);
+    va_end(args);
+    buffer->length += (size_t)n;
+}
+
+/* ============================================================================
+ * SERVICE STATE
+ * ============================================================================ */
+
+struct Service {
+    Board *board;           /* request board, reset for every request */
+    GameState game;         /* VALIDATE's game; visited is ours */
+    int visited_capacity;
+    Buffer input;
+    Buffer output;
+    Buffer result;          /* the current reply's result */
+    SearchStats stats;      /* node budget of the current request */
+};
+
+Service *service_create(void) {
+    Service *service = (Service *)calloc(1, sizeof(Service));
+    if (!service) return NULL;
+
+    service->board = board_create(10, 10);
+    if (!service->board) {
+        free(service);
+        return NULL;
+    }
+    return service;
+}
+
+void service_free(Service *service) {
+    if (!service) return;
+    board_free(service->board);
+    free(service->game.visited);
+    free(service->input.data);
+    free(service->output.data);
+    free(service->result.data);
+    free(service);
+}
+
+/* board_reset() the warm board, growing it when the request is bigger */
+static bool service_reset_board(Service *service, int height, int width) {
+    if (board_reset(service->board, height, width)) return true;
+
+    Board *board = board_create(height, width);
+    if (!board) return false;
+    board_free(service->board);
+    service->board = board;
+    return true;
+}
+
+/* ============================================================================
+ * BOARD TEXT
+ * ============================================================================ */
+
+/*
+ * Parse a board token into the warm board. Returns NULL on success,
+ * otherwise what is wrong.
+ */
+static const char *parse_board(Service *service, const char *text) {
+    if ((text[0] != 'R' && text[0] != 'C') || text[1] != ':') {
+        return "board must start with R: or C:";
+    }
+    const char *cells = text + 2;
+
+    /* Shape first: rows of equal width */
+    int height = 1, width = 1, row_width = 1;
+    for (const char *p = cells; *p; p++) {
+        if (*p == ',') {
+            row_width++;
+        } else if (*p == '/') {
+            if (height == 1) width = row_width;
+            else if (row_width != width) return "rows differ in width";
+            height++;
+            row_width = 1;
+        }
+    }
+    if (height == 1) width = row_width;
+    else if (row_width != width) return "rows differ in width";
+    if (height > SERVICE_MAX_SIDE || width > SERVICE_MAX_SIDE) return "board too large";
+
+    if (!service_reset_board(service, height, width)) return "out of memory";
+    Board *board = service->board;
+    board_set_rules(board, text[0] == 'C' ? RULES_FULL_COVERAGE : RULES_REACH_LAST);
+
+    int numbers = 0;
+    const char *p = cells;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++, p++) {
+            if (*p == '.') {
+                p++;
+            } else if (*p == '#') {
+                board_set_wall(board, i, j);
+                p++;
+            } else {
+                char *end;
+                long number = strtol(p, &end, 10);
+                if (end == p || number < 1 || number > height * width) {
+                    return "bad cell";
+                }
+                board_set_number(board, i, j, (int)number);
+                numbers++;
+                p = end;
+            }
+            if (*p != (j + 1 < width ? ',' : i + 1 < height ? '/' : '\0')) {
+                return "bad cell";
+            }
+        }
+    }
+
+    /* Each of 1..max_number exactly once */
+    if (numbers == 0 || numbers != board->max_number) return "numbers must be 1..N, each once";
+    for (int k = 1; k <= board->max_number; k++) {
+        if (board_number_index(board, k) < 0) return "numbers must be 1..N, each once";
+    }
+    return NULL;
+}
+
+static void format_board(Buffer *out, const Board *board) {
+    if (!buffer_reserve(out, 2 + (size_t)board->height * board->width * CELL_TEXT_MAX)) {
+        return;
+    }
+
+    char *p = out->data + out->length;
+    *p++ = board->rules == RULES_FULL_COVERAGE ? 'C' : 'R';
+    *p++ = ':';
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            const Cell *cell = board_cell(board, i, j);
+            if (j > 0) *p++ = ',';
+            else if (i > 0) *p++ = '/';
+
+            switch (cell->type) {
+                case CELL_WALL:
+                    *p++ = '#';
+                    break;
+                case CELL_NUMBER:
+                    p += sprintf(p, "%d", cell->number);
+                    break;
+                default:
+                    *p++ = '.';
+                    break;
+            }
+        }
+    }
+    out->length = (size_t)(p - out->data);
+}
+
+/* ============================================================================
+ * REQUESTS
+ * ============================================================================ */
+
+static bool parse_int(const char *text, long min, long max, long *value) {
+    char *end;
+    errno = 0;
+    *value = strtol(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0 && *value >= min && *value <= max;
+}
+
+static bool parse_ratio(const char *text, float *value) {
+    char *end;
+    *value = strtof(text, &end);
+    return end != text && *end == '\0' && *value >= 0.0f && *value <= 1.0f;
+}
+
+/* Fresh statistics carrying the node budget of a request on cells cells */
+static SearchStats *start_budget(Service *service, long cells) {
+    search_stats_reset(&service->stats);
+    service->stats.node_limit = SERVICE_MAX_WORK / cells < SERVICE_MAX_NODES ?
+                                SERVICE_MAX_WORK / cells : SERVICE_MAX_NODES;
+    return &service->stats;
+}
+
+/* Each handler fills service->result and returns NULL, or returns an error */
+
+static const char *handle_generate(Service *service, char **args, int count) {
+    long rows, cols, seed, clues = 0;
+    float path_ratio, wall_ratio;
+
+    if (count != 5 && count != 6) {
+        return "usage: GENERATE rows cols path_ratio wall_ratio seed [clues]";
+    }
+    if (!parse_int(args[0], SERVICE_MIN_SIDE, SERVICE_MAX_SIDE, &rows) ||
+        !parse_int(args[1], SERVICE_MIN_SIDE, SERVICE_MAX_SIDE, &cols)) {
+        return "rows and cols must be 5..100";
+    }
+    if (!parse_ratio(args[2], &path_ratio) || !parse_ratio(args[3], &wall_ratio)) {
+        return "ratios must be 0..1";
+    }
+    if (!parse_int(args[4], 0, 0xFFFFFFFFL, &seed)) return "bad seed";
+    if (count == 6 && !parse_int(args[5], 2, rows * cols, &clues)) return "bad clues";
+
+    SearchStats *stats = start_budget(service, rows * cols);
+    Board *board = clues > 0 ?
+        generate_sparse_puzzle_stats((int)rows, (int)cols, path_ratio, wall_ratio,
+                                     (unsigned int)seed, SERVICE_MAX_ATTEMPTS,
+                                     (int)clues, stats) :
+        generate_unique_puzzle_stats((int)rows, (int)cols, path_ratio, wall_ratio,
+                                     (unsigned int)seed, SERVICE_MAX_ATTEMPTS, stats);
+    if (!board) return search_stats_spent(stats) ? "budget exceeded" : "no puzzle found";
+
+    format_board(&service->result, board);
+    board_free(board);
+    return NULL;
+}
+
+static const char *handle_count(Service *service, char **args, int count) {
+    long max_solutions = 2;
+
+    if (count != 1 && count != 2) return "usage: COUNT board [max_solutions]";
+    if (count == 2 && !parse_int(args[1], 1, 1000000, &max_solutions)) {
+        return "max_solutions must be 1..1000000";
+    }
+
+    const char *error = parse_board(service, args[0]);
+    if (error) return error;
+
+    const Board *board = service->board;
+    SearchStats *stats = start_budget(service, (long)board->height * board->width);
+    int solutions = puzzle_count_solutions_ex(board, (int)max_solutions, NULL, stats);
+    if (solutions < 0) return "budget exceeded";
+
+    buffer_printf(&service->result, "%d", solutions);
+    return NULL;
+}
+
+/* game_state_create() on the warm visited array */
+static bool start_game(Service *service) {
+    const Board *board = service->board;
+    int cells = board_cell_count(board);
+
+    if (cells > service->visited_capacity) {
+        bool *visited = (bool *)realloc(service->game.visited, cells * sizeof(bool));
+        if (!visited) return false;
+        service->game.visited = visited;
+        service->visited_capacity = cells;
+    }
+    memset(service->game.visited, 0, cells * sizeof(bool));
+
+    int start = board_number_index(board, 1);
+    service->game.board = board;
+    service->game.player.row = board_index_row(board, start);
+    service->game.player.col = board_index_col(board, start);
+    service->game.player.next_number = 2;
+    service->game.visited[start] = true;
+    service->game.visited_hash = board_cell_key(start);
+    return true;
+}
+
+static const char *handle_validate(Service *service, char **args, int count) {
+    if (count != 2) return "usage: VALIDATE board moves";
+
+    const char *error = parse_board(service, args[0]);
+    if (error) return error;
+    if (!start_game(service)) return "out of memory";
+
+    const char *moves = strcmp(args[1], "-") == 0 ? "" : args[1];
+    for (int i = 0; moves[i]; i++) {
+        if (!movement_try_move(&service->game, moves[i])) {
+            buffer_printf(&service->result, "invalid %d", i);
+            return NULL;
+        }
+    }
+
+    if (game_state_check_win(&service->game)) {
+        buffer_printf(&service->result, "solved");
+    } else {
+        buffer_printf(&service->result, "incomplete %d",
+                      service->game.player.next_number);
+    }
+    return NULL;
+}
+
+/*
+ * Answer one request line (NUL-terminated, newline stripped), appending
+ * the reply to the output. Returns false for QUIT.
+ */
+static bool handle_line(Service *service, char *line) {
+    double start = search_stats_now();
+    char *tokens[SERVICE_MAX_TOKENS];
+    int count = 0;
+    bool more = true;
+
+    /* Tokens past SERVICE_MAX_TOKENS are counted but not kept */
+    for (char *p = line; *p; ) {
+        while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+        if (!*p) break;
+        if (count < SERVICE_MAX_TOKENS) tokens[count] = p;
+        count++;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r') p++;
+        if (*p) *p++ = '\0';
+    }
+    if (count == 0) return true;    /* blank line */
+
+    const char *error = NULL;
+    service->result.length = 0;
+    if (count < 2) {
+        error = "missing command";
+    } else if (count > SERVICE_MAX_TOKENS) {
+        error = "too many arguments";
+    } else if (strcmp(tokens[1], "GENERATE") == 0) {
+        error = handle_generate(service, tokens + 2, count - 2);
+    } else if (strcmp(tokens[1], "COUNT") == 0) {
+        error = handle_count(service, tokens + 2, count - 2);
+    } else if (strcmp(tokens[1], "VALIDATE") == 0) {
+        error = handle_validate(service, tokens + 2, count - 2);
+    } else if (strcmp(tokens[1], "QUIT") == 0) {
+        buffer_printf(&service->result, "bye");
+        more = false;
+    } else {
+        error = "unknown command";
+    }
+
+    double micros = (search_stats_now() - start) * 1e6;
+    if (error) {
+        buffer_printf(&service->output, "%s ERR %.1f %s\n", tokens[0], micros, error);
+    } else {
+        buffer_printf(&service->output, "%s OK %.1f %.*s\n", tokens[0], micros,
+                      (int)service->result.length,
+                      service->result.data ? service->result.data : "");
+    }
+    return more;
+}
+
+/* ============================================================================
+ * TRANSPORT
+ * ============================================================================ */
+
+static bool write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+bool service_run(Service *service, int in_fd, int out_fd) {
+    Buffer *input = &service->input;
+    Buffer *output = &service->output;
+    bool more = true;
+    bool ok = true;
+
+    input->length = 0;
+
+    while (more) {
+        if (!buffer_reserve(input, SERVICE_READ_CHUNK + 1)) {
+            ok = false;
+            break;
+        }
+        ssize_t n = read(in_fd, input->data + input->length, SERVICE_READ_CHUNK);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) ok = false;
+        bool closed = n <= 0;
+        if (!closed) input->length += (size_t)n;
+
+        /* Every complete line in one go; at end of input, the rest too */
+        size_t consumed = 0;
+        output->length = 0;
+        while (more && consumed < input->length) {
+            char *line = input->data + consumed;
+            char *newline = memchr(line, '\n', input->length - consumed);
+            if (!newline && !closed) break;
+
+            size_t length = newline ? (size_t)(newline - line) : input->length - consumed;
+            line[length] = '\0';
+            consumed += length + (newline ? 1 : 0);
+            more = handle_line(service, line);
+        }
+        input->length -= consumed;
+        memmove(input->data, input->data + consumed, input->length);
+
+        if (output->length > 0 && !write_all(out_fd, output->data, output->length)) {
+            ok = false;
+            break;
+        }
+        if (closed) break;
+        if (input->length > SERVICE_MAX_LINE) {
+            static const char too_long[] = "- ERR 0.0 line too long\n";
+            write_all(out_fd, too_long, sizeof(too_long) - 1);
+            ok = false;
+            break;
+        }
+    }
+
+    return ok;
+}
+
+bool service_listen(Service *service, const char *path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    strcpy(address.sun_path, path);
+
+    struct stat info;
+    if (lstat(path, &info) == 0 && S_ISSOCK(info.st_mode)) {
+        unlink(path);
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listener, 16) != 0) {
+        int saved = errno;
+        close(listener);
+        errno = saved;
+        return false;
+    }
+
+    for (;;) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            int saved = errno;
+            close(listener);
+            errno = saved;
+            return false;
+        }
+        service_run(service, connection, connection);
+        close(connection);
+    }
+}
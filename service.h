@@ -0,0 +1,89 @@
+/*
+ * service.h - Headless Batch Service
+ *
+ * A long-lived process that answers generate/count/validate requests,
+ * so callers stop paying process startup and fresh allocations per
+ * puzzle. The same line protocol runs over stdin/stdout or a Unix
+ * socket.
+ *
+ * Requests, one per line; id is any token and is echoed back:
+ *   <id> GENERATE <rows> <cols> <path_ratio> <wall_ratio> <seed> [clues]
+ *   <id> COUNT <board> [max_solutions]
+ *   <id> VALIDATE <board> <moves>
+ *   <id> QUIT
+ *
+ * Replies, one per request, in request order:
+ *   <id> OK <micros> <result>
+ *   <id> ERR <micros> <reason>
+ *
+ * micros is the time spent on the request, from reading its line to
+ * formatting its reply. Results:
+ *   GENERATE - A unique puzzle (generate_unique_puzzle(), thinned to
+ *              clues numbers with generate_sparse_puzzle() when given)
+ *   COUNT    - puzzle_count_solutions() (max_solutions defaults to 2)
+ *   VALIDATE - "solved", "incomplete <next_number>" or "invalid <i>"
+ *              when move i (from 0) is rejected
+ *   QUIT     - "bye", then the session ends
+ *
+ * A line with more than 8 tokens (id and command included) gets ERR
+ * rather than having the extra ones dropped.
+ *
+ * Bounds, so one request cannot stall the ones queued behind it:
+ * boards are at most 100x100, max_solutions at most 1000000, and every
+ * COUNT or GENERATE may expand at most 500000 search nodes, or
+ * 400000000 / (rows * cols) on boards over 800 cells. That is about a
+ * second of search on any board; past it the reply is
+ *   <id> ERR <micros> budget exceeded
+ *
+ * Boards are one token: the rules (R reach last, C full coverage), a
+ * colon, then rows separated by '/', cells by ',': '.' empty, '#' wall
+ * or a number. Moves are movement_try_move() keys, "-" for none.
+ *   1 COUNT R:1,.,./#,#,./3,.,2 2
+ *   1 OK 3.1 1
+ *
+ * Requests may be pipelined: send any number without waiting. Replies
+ * to everything that arrived in one read go out in one write.
+ */
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <stdbool.h>
+
+typedef struct Service Service;
+
+/*
+ * Scratch kept between requests: the request board, the game used for
+ * VALIDATE, and the line and reply buffers. Each only grows.
+ *
+ * Solver and generator scratch is not kept: every COUNT and GENERATE
+ * allocates its search state (visited grid, frame stack, reachability
+ * queue, transposition table) and frees it before replying, as
+ * puzzle_count_solutions() and generate_unique_puzzle() always do.
+ */
+Service *service_create(void);
+void service_free(Service *service);
+
+/*
+ * Answer requests read from in_fd on out_fd until end of input or QUIT
+ *
+ * The process's signal handling is left alone. Ignore SIGPIPE first (as
+ * zip --serve does) so a client hanging up ends the session with a
+ * failed write instead of killing the process.
+ *
+ * Returns:
+ *   false on a read or write error, or a line over 1 MiB
+ */
+bool service_run(Service *service, int in_fd, int out_fd);
+
+/*
+ * Listen on a Unix socket at path and serve its connections one at a
+ * time, forever. A stale socket file at path is replaced; any other
+ * file is left alone and fails the bind.
+ *
+ * Returns:
+ *   false when the socket cannot be set up (errno tells why)
+ */
+bool service_listen(Service *service, const char *path);
+
+#endif /* SERVICE_H */
@@ -11,74 +11,28 @@
  * ============================================================================
  */
 
-static bool **create_visited_grid(int rows, int cols) {
-    bool **visited = (bool **)malloc(rows * sizeof(bool *));
-    if (!visited) return NULL;
-    
-    for (int i = 0; i < rows; i++) {
-        visited[i] = (bool *)calloc(cols, sizeof(bool));
-        if (!visited[i]) {
-            for (int j = 0; j < i; j++) {
-                free(visited[j]);
-            }
-            free(visited);
-            return NULL;
-        }
-    }
-    
-    return visited;
-}
-
-static void free_visited_grid(bool **visited, int rows) {
-    if (!visited) return;
-    for (int i = 0; i < rows; i++) {
-        free(visited[i]);
-    }
-    free(visited);
-}
-
-static bool is_wall(const Cell *cell) {
-    return cell->type == CELL_WALL;
+static bool *create_visited_grid(const Board *board) {
+    return (bool *)calloc(board_cell_count(board), sizeof(bool));
 }
 
 static bool is_number_cell(const Cell *cell) {
     return cell->type == CELL_NUMBER;
 }
 
-static bool find_start_position(const Board *board, int *start_row, int *start_col) {
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            const Cell *cell = &board->grid[i][j];
-            if (is_number_cell(cell) && cell->number == 1) {
-                *start_row = i;
-                *start_col = j;
-                return true;
-            }
-        }
-    }
-    return false;
+static bool find_start_position(const Board *board, int *start) {
+    *start = board_number_index(board, 1);
+    return *start >= 0;
 }
 
-static bool is_in_bounds(const Board *board, int row, int col) {
-    return row >= 0 && row < board->height && col >= 0 && col < board->width;
-}
+/* pos comes from the open_dirs mask, so it is never a wall */
 static bool is_valid_move(
     const Board *board,
-    bool **visited,
-    int row,
-    int col,
+    const bool *visited,
+    int pos,
     int next_number
 ) {
-    if (!is_in_bounds(board, row, col)) {
-        return false;
-    }
-    
-    const Cell *cell = &board->grid[row][col];
-    if (is_wall(cell)) {
-        return false;
-    }
-    
-    if (visited[row][col]) {
+    const Cell *cell = &board->cells[pos];
+    if (visited[pos]) {
         return false;
     }
     
@@ -91,68 +45,144 @@ static bool is_valid_move(
     return true;
 }
 
-static bool solve_dfs(
+/*
+ * One frame per path cell on an explicit heap stack, so the search depth
+ * is bounded by the heap rather than the thread stack.
+ */
+typedef struct {
+    int pos;
+    int next_number;
+    unsigned moves;     /* legal_moves() not tried yet, board_moves_toward() order */
+} SolveFrame;
+
+/*
+ * Under full coverage a path that reaches the last number only counts
+ * once it holds every open cell; otherwise it has nowhere left to go
+ */
+static bool path_complete(const Board *board, int path_length, int open_cells) {
+    return board->rules != RULES_FULL_COVERAGE || path_length == open_cells;
+}
+
+/*
+ * Directions a path heading for next_number may take from pos, those
+ * toward next_number's cell first. Only frames above this one change
+ * visited, and they are gone again before it resumes, so the set stays
+ * valid for the frame's whole life.
+ * 
+ * Under full coverage heading straight for the next number strands the
+ * cells around it, so those boards keep the fixed order.
+ */
+static unsigned legal_moves(
     const Board *board,
-    bool **visited,
-    int row,
-    int col,
+    const bool *visited,
+    int pos,
     int next_number
 ) {
-    if (next_number > board->max_number) {
-        return true;  
+    unsigned moves = 0;
+    for (unsigned open = board->open_dirs[pos]; open; open &= open - 1) {
+        int dir = __builtin_ctz(open);
+        if (is_valid_move(board, visited, pos + board->delta[dir], next_number)) {
+            moves |= 1u << dir;
+        }
+    }
+    if (board->rules == RULES_FULL_COVERAGE) {
+        return moves;
+    }
+    return board_moves_toward(board, pos, board_number_index(board, next_number),
+                              moves);
+}
+
+static bool solve_dfs(
+    const Board *board,
+    bool *visited,
+    SolveFrame *stack,
+    int start,
+    SearchStats *stats
+) {
+    int open_cells = board_count_open_cells(board);
+    
+    if (board->max_number < 2) {
+        return path_complete(board, 1, open_cells);
     }
     
-    const int dr[] = {-1, 1, 0, 0};
-    const int dc[] = {0, 0, -1, 1};
+    int depth = 0;
     
-    for (int dir = 0; dir < 4; dir++) {
-        int new_row = row + dr[dir];
-        int new_col = col + dc[dir];
+    stack[depth++] = (SolveFrame){start, 2, legal_moves(board, visited, start, 2)};
+    if (stats) search_stats_node(stats, 0);
+    
+    while (depth > 0) {
+        SolveFrame *top = &stack[depth - 1];
         
-        if (!is_valid_move(board, visited, new_row, new_col, next_number)) {
-            continue;  
+        if (!top->moves) {
+            visited[top->pos] = false;
+            depth--;
+            if (stats) stats->backtracks++;
+            continue;
         }
         
-        const Cell *target_cell = &board->grid[new_row][new_col];
-        int next_next_number = next_number;
+        int dir = __builtin_ctz(top->moves) & 3;
+        top->moves &= top->moves - 1;
+        int new_pos = top->pos + board->delta[dir];
+        int next_next_number = top->next_number;
         
-        if (is_number_cell(target_cell)) {
+        if (is_number_cell(&board->cells[new_pos])) {
             next_next_number++;
         }
         
-        visited[new_row][new_col] = true;
-        
-        if (solve_dfs(board, visited, new_row, new_col, next_next_number)) {
-            return true;  
+        if (next_next_number > board->max_number) {
+            if (path_complete(board, depth + 1, open_cells)) {
+                return true;
+            }
+            continue;
         }
         
-        visited[new_row][new_col] = false;
+        visited[new_pos] = true;
+        if (stats) search_stats_node(stats, depth);
+        stack[depth++] = (SolveFrame){new_pos, next_next_number,
+                                      legal_moves(board, visited, new_pos,
+                                                  next_next_number)};
     }
     
     return false;
 }
 
 bool puzzle_has_solution(const Board *board) {
-    if (!board || !board->grid) {
+    return puzzle_has_solution_stats(board, NULL);
+}
+
+bool puzzle_has_solution_stats(const Board *board, SearchStats *stats) {
+    if (!board || !board->cells) {
         return false;
     }
     
-    int start_row, start_col;
-    if (!find_start_position(board, &start_row, &start_col)) {
+    int start;
+    if (!find_start_position(board, &start)) {
         return false;
     }
     
-    bool **visited = create_visited_grid(board->height, board->width);
+    bool *visited = create_visited_grid(board);
     if (!visited) {
         return false;
     }
     
-    visited[start_row][start_col] = true;
+    /* A path never holds more cells than the board */
+    SolveFrame *stack = (SolveFrame *)malloc(board_cell_count(board) * sizeof(SolveFrame));
+    if (!stack) {
+        free(visited);
+        return false;
+    }
     
-
-    bool has_solution = solve_dfs(board, visited, start_row, start_col, 2);
+    if (stats) {
+        search_stats_alloc(stats, 2, board_cell_count(board) *
+                                     (sizeof(bool) + sizeof(SolveFrame)));
+    }
     
-    free_visited_grid(visited, board->height);
+    visited[start] = true;
+    
+    bool has_solution = solve_dfs(board, visited, stack, start, stats);
+    
+    free(stack);
+    free(visited);
     
     return has_solution;
 }
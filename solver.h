@@ -6,7 +6,14 @@
 #define SOLVER_H
 
 #include "engine.h"
+#include "search_stats.h"
 
 bool puzzle_has_solution(const Board *board);
 
+/*
+ * puzzle_has_solution() that adds its nodes, backtracks, depths and
+ * allocations to stats (NULL records nothing)
+ */
+bool puzzle_has_solution_stats(const Board *board, SearchStats *stats);
+
 #endif
@@ -5,165 +5,643 @@
  */
 
 #include "solver_count.h"
+#include "solver_internal.h"
+#include "solver_table.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* ============================================================================
  * VISITED GRID MANAGEMENT (Same as existence solver)
  * ============================================================================ */
 
-static bool **create_visited_grid(int rows, int cols) {
-    bool **visited = (bool **)malloc(rows * sizeof(bool *));
-    if (!visited) return NULL;
+static bool *create_visited_grid(const Board *board) {
+    return (bool *)calloc(board_cell_count(board), sizeof(bool));
+}
+
+/* ============================================================================
+ * MOVEMENT VALIDATION (Same as existence solver)
+ * ============================================================================ */
+
+static bool is_valid_move(const Board *board, const bool *visited,
+                         int pos, int next_number) {
+    /* No wall check needed: pos comes from the board's open_dirs mask */
+    const Cell *cell = &board->cells[pos];
     
-    for (int i = 0; i < rows; i++) {
-        visited[i] = (bool *)calloc(cols, sizeof(bool));
-        if (!visited[i]) {
-            for (int j = 0; j < i; j++) {
-                free(visited[j]);
-            }
-            free(visited);
-            return NULL;
-        }
+    /* Visited check */
+    if (visited[pos]) {
+        return false;
     }
     
-    return visited;
-}
-
-static void free_visited_grid(bool **visited, int rows) {
-    if (!visited) return;
-    for (int i = 0; i < rows; i++) {
-        free(visited[i]);
+    /* Number ordering check */
+    if (cell->type == CELL_NUMBER) {
+        if (cell->number != next_number) {
+            return false;
+        }
     }
-    free(visited);
+    
+    return true;
 }
 
 /* ============================================================================
- * MOVEMENT VALIDATION (Same as existence solver)
+ * SEARCH STATE
  * ============================================================================ */
 
-static bool is_in_bounds(const Board *board, int row, int col) {
-    return row >= 0 && row < board->height && col >= 0 && col < board->width;
+/* One explicit stack frame per path cell */
+typedef struct {
+    int pos;
+    int next_number;
+    unsigned moves;     /* open directions still to try, see frame_moves() */
+    int dir;            /* direction of the move last tried */
+} CountFrame;
+
+typedef struct {
+    const Board *board;
+    bool *visited;
+    CountFrame *stack;   /* a path never holds more cells than the board */
+    int *number_pos;     /* number -> cell index, 1..max_number */
+    int ring[8];         /* offsets of the 8 surrounding cells, clockwise */
+    
+    /* Reachability scratch: BFS queue plus per-cell generation stamps,
+     * so a new search never has to clear the marks */
+    SolverReach reach;
+    
+    bool prune;
+    int solution_count;
+    int max_solutions;
+    unsigned long nodes;
+    
+    /* Full coverage (RULES_FULL_COVERAGE): a solution must hold all
+     * open_cells open cells */
+    bool coverage;
+    int open_cells;
+    
+    /* Transposition table (solver_table.h), used when table_bytes > 0.
+     * It is only set up once nodes reaches SOLVER_TABLE_MIN_NODES, and
+     * visited_hash is only kept from then on */
+    size_t table_bytes;
+    bool table_on;
+    SolverTable table;
+    uint64_t visited_hash;
+    
+    /* Optional statistics (NULL: record nothing). base_depth is the path
+     * length before the first frame, for searches resumed from a prefix.
+     * out_of_nodes is set once stats->node_limit is spent */
+    SearchStats *stats;
+    int base_depth;
+    bool out_of_nodes;
+    
+    /* Parallel search: solutions go to this counter shared by all
+     * workers instead of solution_count, so every worker sees the limit */
+    atomic_int *shared_count;
+    
+    /* Optional restriction: the path may not enter forbid_pos while it
+     * is heading for forbid_number (forbid_pos < 0 means none) */
+    int forbid_pos;
+    int forbid_number;
+    
+    /* Optional witness: the cells of the most recent solution found */
+    int *witness;
+    int witness_length;
+    
+    /* Optional enumeration: each solution is written to moves and passed
+     * to on_solution; stopped is set once the callback declines more */
+    SolutionCallback on_solution;
+    void *user;
+    char *moves;
+    int delivered;
+    bool stopped;
+} CountSearch;
+
+static void count_search_free(CountSearch *s) {
+    if (s->table_on) {
+        solver_table_free(&s->table);
+    }
+    free(s->visited);
+    free(s->stack);
+    free(s->number_pos);
+    free(s->reach.queue);
+    free(s->reach.seen);
 }
 
-static bool is_valid_move(const Board *board, bool **visited, 
-                         int row, int col, int next_number) {
-    /* Bounds check */
-    if (!is_in_bounds(board, row, col)) {
+static bool count_search_init(CountSearch *s, const Board *board,
+                              int max_solutions, bool prune,
+                              SearchStats *stats) {
+    int cells = board_cell_count(board);
+    
+    s->board = board;
+    s->reach.generation = 0;
+    s->prune = prune;
+    s->solution_count = 0;
+    s->max_solutions = max_solutions;
+    s->nodes = 0;
+    s->coverage = board->rules == RULES_FULL_COVERAGE;
+    s->open_cells = s->coverage ? board_count_open_cells(board) : 0;
+    s->table_bytes = 0;
+    s->table_on = false;
+    s->visited_hash = 0;
+    s->stats = stats;
+    s->base_depth = 0;
+    s->out_of_nodes = false;
+    s->shared_count = NULL;
+    s->forbid_pos = -1;
+    s->forbid_number = 0;
+    s->witness = NULL;
+    s->witness_length = 0;
+    s->on_solution = NULL;
+    s->user = NULL;
+    s->moves = NULL;
+    s->delivered = 0;
+    s->stopped = false;
+    
+    solver_ring_offsets(board, s->ring);
+    
+    s->visited = create_visited_grid(board);
+    s->stack = (CountFrame *)malloc(cells * sizeof(CountFrame));
+    s->number_pos = (int *)calloc(board->max_number + 1, sizeof(int));
+    s->reach.queue = (int *)malloc(cells * sizeof(int));
+    s->reach.seen = (unsigned *)calloc(cells, sizeof(unsigned));
+    if (!s->visited || !s->stack || !s->number_pos || !s->reach.queue ||
+        !s->reach.seen) {
+        count_search_free(s);
         return false;
     }
+    if (stats) {
+        search_stats_alloc(stats, 5, cells * (sizeof(bool) + sizeof(CountFrame) +
+                                              sizeof(int) + sizeof(unsigned)) +
+                                     (board->max_number + 1) * sizeof(int));
+    }
     
-    /* Wall check */
-    const Cell *cell = &board->grid[row][col];
-    if (cell->type == CELL_WALL) {
-        return false;
+    /* 0 for a missing number: such boards have no solution anyway */
+    for (int n = 1; n <= board->max_number; n++) {
+        int index = board_number_index(board, n);
+        s->number_pos[n] = index > 0 ? index : 0;
     }
     
-    /* Visited check */
-    if (visited[row][col]) {
-        return false;
+    return true;
+}
+
+/* ============================================================================
+ * REACHABILITY PRUNING
+ * ============================================================================ */
+
+static void count_prune(CountSearch *s, PruneReason reason) {
+    if (s->stats) {
+        s->stats->prunes[reason]++;
+    }
+}
+
+/*
+ * solver_head_reaches() for this search: left is the numbers still to
+ * reach (under full coverage, the open cells off the path_length-cell
+ * path), and a segment heading for forbid_number skips forbid_pos
+ */
+static bool head_reaches(CountSearch *s, int head, int target, int next_number,
+                         int path_length) {
+    int left = s->coverage ? s->open_cells - path_length
+                           : s->board->max_number - next_number + 1;
+    int forbid = next_number == s->forbid_number ? s->forbid_pos : -1;
+    return solver_head_reaches(&s->reach, s->board, s->visited, s->coverage,
+                               head, target, forbid, left);
+}
+
+/*
+ * Full coverage: an unvisited open cell needs two free neighbors (a way
+ * in and a way out) unless it is the last number, where the path ends
+ * and one will do. The head counts as free. Returns false and records
+ * why when some cell near pos falls short.
+ * 
+ * When the head steps from prev onto pos, prev stops being the head, so
+ * only prev's neighbors lose a free neighbor; at the start (prev < 0)
+ * every cell is checked.
+ */
+static bool coverage_cell_ok(CountSearch *s, int cell, int head) {
+    if (s->board->cells[cell].type == CELL_WALL || s->visited[cell]) {
+        return true;
     }
     
-    /* Number ordering check */
-    if (cell->type == CELL_NUMBER) {
-        if (cell->number != next_number) {
-            return false;
+    int need = cell == s->number_pos[s->board->max_number] ? 1 : 2;
+    int open = solver_free_neighbors(s->board, s->visited, cell, head);
+    if (open >= need) {
+        return true;
+    }
+    
+    count_prune(s, open == 0 ? PRUNE_ISOLATED_CELL : PRUNE_DEAD_END);
+    return false;
+}
+
+static bool coverage_degrees_ok(CountSearch *s, int prev, int pos) {
+    if (prev < 0) {
+        for (int i = 0; i < board_cell_count(s->board); i++) {
+            if (!coverage_cell_ok(s, i, pos)) return false;
         }
+        return true;
     }
     
+    for (unsigned moves = s->board->open_dirs[prev]; moves; moves &= moves - 1) {
+        int n = prev + s->board->delta[__builtin_ctz(moves)];
+        if (!coverage_cell_ok(s, n, pos)) return false;
+    }
     return true;
 }
 
+/*
+ * True when the branch ending at pos can be abandoned: the next number is
+ * no longer reachable through blank cells, or some later number (under
+ * full coverage: some open cell) is no longer reachable at all.
+ */
+static bool branch_is_cut_off(CountSearch *s, int prev, int pos, int next_number,
+                              int path_length) {
+    if (!head_reaches(s, pos, s->number_pos[next_number], next_number, path_length)) {
+        count_prune(s, PRUNE_NEXT_UNREACHABLE);
+        return true;
+    }
+    
+    if (s->coverage && !coverage_degrees_ok(s, prev, pos)) {
+        return true;
+    }
+    
+    if (prev >= 0 &&
+        !solver_step_may_split(s->board, s->ring, s->visited, prev, pos)) {
+        return false;
+    }
+    
+    if (!head_reaches(s, pos, -1, next_number, path_length)) {
+        count_prune(s, s->coverage ? PRUNE_REGION_SPLIT : PRUNE_NUMBER_CUT_OFF);
+        return true;
+    }
+    return false;
+}
+
 /* ============================================================================
- * DFS SOLUTION COUNTING CORE
+ * TRANSPOSITION TABLE
  * ============================================================================ */
 
 /*
- * Recursive DFS that counts all valid solution paths
+ * Switch the table on partway through a search: hash the cells already
+ * visited, and mark the depth frames on the stack as predating the table
+ * (their subtrees were partly counted without it, so they are not stored)
  */
-static void dfs_count(
-    const Board *board,
-    bool **visited,
-    int row,
-    int col,
-    int next_number,
-    int *solution_count,
-    int max_solutions
-) {
-    /* EARLY EXIT OPTIMIZATION
-     * 
-     * If we've already found enough solutions, stop searching.
-     * This is CRITICAL for performance:
-     * - For uniqueness (max=2): stops as soon as 2nd solution found
-     * - Prevents exhaustive search when we only need to know ">=2"
-     */
-    if (*solution_count >= max_solutions) {
+static void count_table_start(CountSearch *s, int depth) {
+    int cells = board_cell_count(s->board);
+    
+    if (!solver_table_init(&s->table, cells, s->table_bytes)) {
+        s->table_bytes = 0;    /* carry on without it */
         return;
     }
+    s->table_on = true;
+    if (s->stats) {
+        search_stats_alloc(s->stats, 3, solver_table_bytes(cells, s->table_bytes));
+    }
     
+    s->visited_hash = 0;
+    for (int i = 0; i < cells; i++) {
+        if (s->visited[i]) s->visited_hash ^= s->table.cell_keys[i];
+    }
+    for (int d = 0; d < depth; d++) {
+        s->table.frames[d].key = 0;
+    }
+}
+
+/*
+ * Look up the state just entered at pos; on a hit its stored count is
+ * added and *key is left unused
+ */
+static bool count_table_hit(CountSearch *s, int pos, int next_number, uint64_t *key) {
+    int count;
+    
+    *key = solver_table_key(&s->table, s->visited_hash, pos, next_number);
+    if (s->stats) s->stats->table_probes++;
+    if (!solver_table_probe(&s->table, *key, &count)) {
+        return false;
+    }
+    
+    if (s->stats) s->stats->table_hits++;
+    s->solution_count += count;
+    return true;
+}
+
+/*
+ * Store the count of the subtree under the frame at depth, which is
+ * being popped
+ */
+static void count_table_leave(CountSearch *s, int depth, int pos) {
+    const TableFrame *frame = &s->table.frames[depth];
+    
+    if (frame->key) {
+        int count = s->solution_count - frame->count;
+        solver_table_store(&s->table, frame->key,
+                           count < s->max_solutions ? count : s->max_solutions,
+                           s->nodes - frame->nodes);
+    }
+    s->visited_hash ^= s->table.cell_keys[pos];
+}
+
+/* ============================================================================
+ * DFS SOLUTION COUNTING CORE
+ * ============================================================================ */
+
+/*
+ * True when a path of path_length cells that now heads for next_number
+ * is a solution
+ */
+static bool path_complete(const CountSearch *s, int next_number, int path_length) {
+    return next_number > s->board->max_number &&
+           (!s->coverage || path_length == s->open_cells);
+}
+
+/*
+ * Decide whether a freshly entered cell (the path now holds path_length
+ * cells) is worth expanding
+ */
+static bool dfs_enter(CountSearch *s, int prev, int pos, int next_number,
+                      int path_length) {
     /* BASE CASE: Found a complete valid path
      * 
      * Unlike existence solver which returns true here,
      * we INCREMENT the counter and CONTINUE via backtracking
      * to find other possible solutions.
+     * 
+     * Under full coverage the last number ends the path, so reaching it
+     * with open cells left is a dead end rather than a solution.
      */
-    if (next_number > board->max_number) {
-        (*solution_count)++;
-        return;  /* Backtrack to explore other paths */
+    if (next_number > s->board->max_number) {
+        if (!path_complete(s, next_number, path_length)) {
+            return false;
+        }
+        if (s->shared_count) {
+            atomic_fetch_add_explicit(s->shared_count, 1, memory_order_relaxed);
+        } else {
+            s->solution_count++;
+        }
+        return false;  /* Backtrack to explore other paths */
     }
     
-    /* Direction vectors: up, down, left, right */
-    const int dr[] = {-1, 1, 0, 0};
-    const int dc[] = {0, 0, -1, 1};
+    /* REACHABILITY PRUNING
+     * 
+     * Without this, a branch only dies when it runs out of moves, and
+     * in an open area that can take millions of nodes after the next
+     * number has already been walled off by the path itself.
+     */
+    if (s->prune && branch_is_cut_off(s, prev, pos, next_number, path_length)) {
+        return false;
+    }
     
-    /* Try all four directions */
-    for (int dir = 0; dir < 4; dir++) {
-        int new_row = row + dr[dir];
-        int new_col = col + dc[dir];
+    return true;
+}
+
+/*
+ * True once enough solutions have been found, by this search or by any
+ * worker sharing its counter
+ */
+static bool dfs_done(const CountSearch *s) {
+    if (s->stopped || s->out_of_nodes) {
+        return true;
+    }
+    if (s->shared_count) {
+        return atomic_load_explicit(s->shared_count, memory_order_relaxed) >=
+               s->max_solutions;
+    }
+    return s->solution_count >= s->max_solutions;
+}
+
+/*
+ * Record an expanded node, and stop the search once the statistics'
+ * node_limit is spent (s->stats must not be NULL)
+ */
+static void count_node(CountSearch *s, int depth) {
+    search_stats_node(s->stats, depth);
+    if (search_stats_spent(s->stats)) {
+        s->out_of_nodes = true;
+    }
+}
+
+/*
+ * A new frame's directions, those toward the number it heads for first
+ * (board_moves_toward()); full-coverage boards keep the fixed order, as
+ * in solver.c. Ordering only decides which solutions turn up first: a
+ * max_solutions = 2 check on an ambiguous board stops sooner,
+ * exhaustive counts do the same work.
+ */
+static unsigned frame_moves(const CountSearch *s, int pos, int next_number) {
+    const Board *board = s->board;
+    if (board->rules == RULES_FULL_COVERAGE) {
+        return board->open_dirs[pos];
+    }
+    return board_moves_toward(board, pos, s->number_pos[next_number],
+                              board->open_dirs[pos]);
+}
+
+/*
+ * Hand the solution held by the first depth frames, plus last, to the
+ * witness and/or the enumeration callback. A frame's dir is the move
+ * that led to the next frame.
+ */
+static void report_solution(CountSearch *s, int depth, int last) {
+    static const char move_keys[] = {'w', 's', 'a', 'd'};
+    
+    if (s->witness) {
+        for (int i = 0; i < depth; i++) {
+            s->witness[i] = s->stack[i].pos;
+        }
+        s->witness[depth] = last;
+        s->witness_length = depth + 1;
+    }
+    
+    if (s->on_solution) {
+        for (int i = 0; i < depth; i++) {
+            s->moves[i] = move_keys[s->stack[i].dir];
+        }
+        s->delivered++;
+        if (!s->on_solution(s->moves, depth, s->user)) {
+            s->stopped = true;
+        }
+    }
+}
+
+/*
+ * DFS that counts all valid solution paths below an entered cell
+ * 
+ * Runs on the explicit frame stack in CountSearch instead of recursing,
+ * so board size is not limited by the thread stack. Frames are visited
+ * in exactly the order the recursive version would visit them. pos must
+ * already be marked visited and have passed dfs_enter(); the caller
+ * records it in the statistics.
+ */
+static void dfs_count_from(CountSearch *s, int pos, int next_number) {
+    const Board *board = s->board;
+    bool *visited = s->visited;
+    CountFrame *stack = s->stack;
+    int depth = 0;
+    
+    stack[depth++] = (CountFrame){pos, next_number,
+                                  frame_moves(s, pos, next_number), 0};
+    
+    /* EARLY EXIT OPTIMIZATION
+     * 
+     * If we've already found enough solutions, stop searching.
+     * This is CRITICAL for performance:
+     * - For uniqueness (max=2): stops as soon as 2nd solution found
+     * - Prevents exhaustive search when we only need to know ">=2"
+     */
+    while (depth > 0 && !dfs_done(s)) {
+        CountFrame *top = &stack[depth - 1];
+        
+        /* All open directions tried: pop the frame
+         * 
+         * BACKTRACK: Unmark cell to explore other paths
+         * 
+         * This is KEY to counting multiple solutions:
+         * By unmarking, we allow other DFS branches to use this cell
+         * in different solution paths.
+         */
+        if (!top->moves) {
+            visited[top->pos] = false;
+            if (s->table_on) count_table_leave(s, depth - 1, top->pos);
+            depth--;
+            if (s->stats) s->stats->backtracks++;
+            continue;
+        }
+        
+        top->dir = __builtin_ctz(top->moves) & 3;
+        top->moves &= top->moves - 1;
+        int new_pos = top->pos + board->delta[top->dir];
         
         /* Validate move */
-        if (!is_valid_move(board, visited, new_row, new_col, next_number)) {
+        if (!is_valid_move(board, visited, new_pos, top->next_number)) {
+            continue;
+        }
+        if (new_pos == s->forbid_pos && top->next_number == s->forbid_number) {
             continue;
         }
         
         /* Determine next number to find */
-        const Cell *target_cell = &board->grid[new_row][new_col];
-        int next_next_number = next_number;
+        const Cell *target_cell = &board->cells[new_pos];
+        int next_next_number = top->next_number;
         
         if (target_cell->type == CELL_NUMBER) {
             next_next_number++;
         }
         
         /* Mark as visited (explore this branch) */
-        visited[new_row][new_col] = true;
+        visited[new_pos] = true;
         
-        /* Recursively count solutions from new position */
-        dfs_count(board, visited, new_row, new_col, 
-                 next_next_number, solution_count, max_solutions);
-        
-        /* BACKTRACK: Unmark cell to explore other paths
-         * 
-         * This is KEY to counting multiple solutions:
-         * By unmarking, we allow other DFS branches to use this cell
-         * in different solution paths.
-         */
-        visited[new_row][new_col] = false;
+        /* A state counted before needs no second visit */
+        uint64_t key = 0;
+        if (s->table_on) {
+            s->visited_hash ^= s->table.cell_keys[new_pos];
+            if (next_next_number <= board->max_number &&
+                count_table_hit(s, new_pos, next_next_number, &key)) {
+                visited[new_pos] = false;
+                s->visited_hash ^= s->table.cell_keys[new_pos];
+                continue;
+            }
+        }
         
-        /* Check if we should stop early (optimization) */
-        if (*solution_count >= max_solutions) {
-            return;
+        /* Descend into the new position, or undo right away if it is a
+         * solution or a dead branch */
+        int path_length = s->base_depth + depth + 1;
+        if (dfs_enter(s, top->pos, new_pos, next_next_number, path_length)) {
+            if (s->stats) count_node(s, s->base_depth + depth);
+            if (s->table_on) {
+                s->table.frames[depth] = (TableFrame){key, s->solution_count, s->nodes};
+            }
+            stack[depth++] = (CountFrame){new_pos, next_next_number,
+                                          frame_moves(s, new_pos, next_next_number), 0};
+            
+            if (++s->nodes == SOLVER_TABLE_MIN_NODES && s->table_bytes) {
+                count_table_start(s, depth);
+            }
+        } else {
+            if ((s->witness || s->on_solution) &&
+                path_complete(s, next_next_number, path_length)) {
+                report_solution(s, depth, new_pos);
+            }
+            visited[new_pos] = false;
+            if (s->table_on) s->visited_hash ^= s->table.cell_keys[new_pos];
+        }
+    }
+}
+
+static void dfs_count(CountSearch *s, int start) {
+    if (dfs_enter(s, -1, start, 2, 1)) {
+        if (s->stats) count_node(s, 0);
+        dfs_count_from(s, start, 2);
+    } else if ((s->witness || s->on_solution) && path_complete(s, 2, 1)) {
+        report_solution(s, 0, start);
+    }
+}
+
+/*
+ * Full coverage on a checkerboard: consecutive path cells alternate
+ * colors, so a path from number 1 through all open cells fixes how many
+ * of each color there are and the color it ends on
+ */
+static bool coverage_parity_ok(const CountSearch *s) {
+    const Board *board = s->board;
+    int colors[2] = {0, 0};
+    
+    for (int i = 0; i < board_cell_count(board); i++) {
+        if (board->cells[i].type != CELL_WALL) {
+            colors[(i / board->stride + i % board->stride) & 1]++;
         }
     }
+    
+    int first = s->number_pos[1];
+    int last = s->number_pos[board->max_number];
+    int first_color = (first / board->stride + first % board->stride) & 1;
+    int last_color = (last / board->stride + last % board->stride) & 1;
+    
+    if (s->open_cells % 2 == 0) {
+        return colors[0] == colors[1] && last_color != first_color;
+    }
+    return colors[first_color] == colors[!first_color] + 1 &&
+           last_color == first_color;
+}
+
+/*
+ * Checks made once before searching: each segment k -> k+1 must already
+ * be connected through blank cells, and a full-coverage board must pass
+ * the parity test, or no amount of searching helps
+ */
+static bool root_is_feasible(CountSearch *s) {
+    for (int n = 1; n < s->board->max_number; n++) {
+        if (!head_reaches(s, s->number_pos[n], s->number_pos[n + 1], n + 1, 0)) {
+            count_prune(s, PRUNE_SEGMENT_BLOCKED);
+            return false;
+        }
+    }
+    
+    if (s->coverage && !coverage_parity_ok(s)) {
+        count_prune(s, PRUNE_PARITY);
+        return false;
+    }
+    return true;
 }
 
 /* ============================================================================
  * PUBLIC API
  * ============================================================================ */
 
-int puzzle_count_solutions(const Board *board, int max_solutions) {
-    /* Validate input */
-    if (!board || !board->grid || max_solutions <= 0) {
-        return 0;
+/*
+ * A finished search's count, capped at max_solutions (table hits add
+ * whole subtree counts, which can overshoot), or -1 when the node budget
+ * ran out before the count was settled
+ */
+static int count_search_result(const CountSearch *s) {
+    if (s->solution_count >= s->max_solutions) {
+        return s->max_solutions;
     }
+    return s->out_of_nodes ? -1 : s->solution_count;
+}
+
+/*
+ * Run a prepared CountSearch from number 1 and return its count
+ */
+static int grid_count_search(CountSearch *search) {
+    const Board *board = search->board;
     
     /* Find starting position (cell with number 1) */
     int start_row, start_col;
@@ -172,22 +650,502 @@ int puzzle_count_solutions(const Board *board, int max_solutions) {
         return 0;
     }
     
-    /* Allocate visited tracking grid */
-    bool **visited = create_visited_grid(board->height, board->width);
-    if (!visited) {
-        return 0;
-    }
-    
     /* Mark starting position as visited */
-    visited[start_row][start_col] = true;
+    int start = board_index(board, start_row, start_col);
+    search->visited[start] = true;
     
     /* Count solutions via DFS */
-    int solution_count = 0;
-    dfs_count(board, visited, start_row, start_col, 2, 
-             &solution_count, max_solutions);
+    if (!search->prune || root_is_feasible(search)) {
+        dfs_count(search, start);
+    }
+    
+    return count_search_result(search);
+}
+
+/*
+ * Validate input, then allocate visited grid and pruning scratch
+ */
+static bool grid_search_open(CountSearch *search, const Board *board,
+                             int max_solutions, bool prune,
+                             SearchStats *stats) {
+    if (!board || !board->cells || max_solutions <= 0) {
+        return false;
+    }
+    return count_search_init(search, board, max_solutions, prune, stats);
+}
+
+static int grid_count_solutions(const Board *board, int max_solutions,
+                                bool prune, size_t table_bytes,
+                                SearchStats *stats) {
+    CountSearch search;
+    if (!grid_search_open(&search, board, max_solutions, prune, stats)) {
+        return 0;
+    }
+    search.table_bytes = table_bytes;
+    
+    int solution_count = grid_count_search(&search);
     
     /* Cleanup */
-    free_visited_grid(visited, board->height);
+    count_search_free(&search);
     
     return solution_count;
 }
+
+/* ============================================================================
+ * PARALLEL COUNTING
+ * ============================================================================
+ * 
+ * The calling thread expands the search tree breadth-first until there
+ * are enough prefixes to go around, then every worker counts the subtrees
+ * below those prefixes with its own CountSearch. Prefixes are dealt out
+ * round-robin into one deque per worker: the owner pops from the bottom
+ * and an idle worker steals from the top of someone else's deque. All
+ * workers add to one atomic counter and stop once it reaches the limit.
+ */
+
+#define SPLIT_TASKS_PER_THREAD 8
+#define SPLIT_MAX_DEPTH 64
+
+/* Every prefix at one split depth: count paths of length cells each */
+typedef struct {
+    int count;
+    int length;
+    int *paths;
+    int *next_numbers;
+} TaskLevel;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int *items;         /* indices into the TaskLevel */
+    int top;            /* thieves take from here */
+    int bottom;         /* the owner pops from here */
+} TaskDeque;
+
+typedef struct {
+    const Board *board;
+    int max_solutions;
+    bool prune;
+    const TaskLevel *tasks;
+    TaskDeque *deques;
+    int worker_count;
+    atomic_int solution_count;
+    SearchStats *stats;     /* caller's; each worker fills its own copy */
+} ParallelCount;
+
+typedef struct {
+    ParallelCount *shared;
+    int id;
+    SearchStats stats;
+} CountWorker;
+
+static void task_level_free(TaskLevel *level) {
+    free(level->paths);
+    free(level->next_numbers);
+    level->paths = NULL;
+    level->next_numbers = NULL;
+    level->count = 0;
+}
+
+static bool task_level_alloc(TaskLevel *level, int capacity, int length) {
+    level->count = 0;
+    level->length = length;
+    level->paths = (int *)malloc((size_t)capacity * length * sizeof(int));
+    level->next_numbers = (int *)malloc(capacity * sizeof(int));
+    if (!level->paths || !level->next_numbers) {
+        task_level_free(level);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Extend every prefix of level by one legal move. Moves that complete a
+ * solution are counted in s, pruned moves are dropped.
+ */
+static bool split_level(CountSearch *s, const TaskLevel *level, TaskLevel *next) {
+    const Board *board = s->board;
+    int length = level->length;
+    
+    if (!task_level_alloc(next, 4 * level->count, length + 1)) {
+        return false;
+    }
+    
+    for (int t = 0; t < level->count; t++) {
+        const int *path = level->paths + (size_t)t * length;
+        int tail = path[length - 1];
+        int next_number = level->next_numbers[t];
+        
+        for (int i = 0; i < length; i++) s->visited[path[i]] = true;
+        
+        for (unsigned moves = board->open_dirs[tail]; moves; moves &= moves - 1) {
+            int new_pos = tail + board->delta[__builtin_ctz(moves)];
+            if (!is_valid_move(board, s->visited, new_pos, next_number)) {
+                continue;
+            }
+            
+            int next_next_number = next_number;
+            if (board->cells[new_pos].type == CELL_NUMBER) {
+                next_next_number++;
+            }
+            
+            s->visited[new_pos] = true;
+            if (dfs_enter(s, tail, new_pos, next_next_number, length + 1)) {
+                if (s->stats) search_stats_node(s->stats, length);
+                int *dst = next->paths + (size_t)next->count * (length + 1);
+                memcpy(dst, path, length * sizeof(int));
+                dst[length] = new_pos;
+                next->next_numbers[next->count++] = next_next_number;
+            }
+            s->visited[new_pos] = false;
+        }
+        
+        for (int i = 0; i < length; i++) s->visited[path[i]] = false;
+    }
+    
+    return true;
+}
+
+static bool take_task(ParallelCount *shared, int id, int *task) {
+    TaskDeque *own = &shared->deques[id];
+    bool found = false;
+    
+    pthread_mutex_lock(&own->lock);
+    if (own->bottom > own->top) {
+        *task = own->items[--own->bottom];
+        found = true;
+    }
+    pthread_mutex_unlock(&own->lock);
+    
+    for (int k = 1; k < shared->worker_count && !found; k++) {
+        TaskDeque *victim = &shared->deques[(id + k) % shared->worker_count];
+        
+        pthread_mutex_lock(&victim->lock);
+        if (victim->bottom > victim->top) {
+            *task = victim->items[victim->top++];
+            found = true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    
+    return found;
+}
+
+static void *count_worker_main(void *arg) {
+    CountWorker *worker = (CountWorker *)arg;
+    ParallelCount *shared = worker->shared;
+    const TaskLevel *tasks = shared->tasks;
+    
+    /* A worker that cannot allocate simply takes no tasks; the others
+     * steal its share */
+    CountSearch s;
+    if (!count_search_init(&s, shared->board, shared->max_solutions, shared->prune,
+                           shared->stats ? &worker->stats : NULL)) {
+        return NULL;
+    }
+    s.shared_count = &shared->solution_count;
+    s.base_depth = tasks->length - 1;
+    
+    int task;
+    while (!dfs_done(&s) && take_task(shared, worker->id, &task)) {
+        const int *path = tasks->paths + (size_t)task * tasks->length;
+        
+        for (int i = 0; i < tasks->length; i++) s.visited[path[i]] = true;
+        dfs_count_from(&s, path[tasks->length - 1], tasks->next_numbers[task]);
+        for (int i = 0; i < tasks->length; i++) s.visited[path[i]] = false;
+    }
+    
+    count_search_free(&s);
+    return NULL;
+}
+
+static int run_count_workers(ParallelCount *shared, int initial_count) {
+    int workers = shared->worker_count;
+    const TaskLevel *tasks = shared->tasks;
+    int result = 0;
+    
+    shared->deques = (TaskDeque *)calloc(workers, sizeof(TaskDeque));
+    CountWorker *states = (CountWorker *)calloc(workers, sizeof(CountWorker));
+    pthread_t *threads = (pthread_t *)calloc(workers, sizeof(pthread_t));
+    bool *started = (bool *)calloc(workers, sizeof(bool));
+    int *items = (int *)malloc(tasks->count * sizeof(int));
+    if (!shared->deques || !states || !threads || !started || !items) {
+        goto cleanup;
+    }
+    
+    /* Deal tasks round-robin: worker w owns a contiguous slice of items */
+    int next_item = 0;
+    for (int w = 0; w < workers; w++) {
+        TaskDeque *deque = &shared->deques[w];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->items = items + next_item;
+        deque->top = 0;
+        deque->bottom = 0;
+        for (int t = w; t < tasks->count; t += workers) {
+            deque->items[deque->bottom++] = t;
+        }
+        next_item += deque->bottom;
+        
+        states[w].shared = shared;
+        states[w].id = w;
+    }
+    
+    atomic_init(&shared->solution_count, initial_count);
+    
+    /* The calling thread is worker 0 */
+    for (int w = 1; w < workers; w++) {
+        started[w] = pthread_create(&threads[w], NULL,
+                                    count_worker_main, &states[w]) == 0;
+    }
+    count_worker_main(&states[0]);
+    
+    for (int w = 1; w < workers; w++) {
+        if (started[w]) pthread_join(threads[w], NULL);
+    }
+    
+    result = atomic_load(&shared->solution_count);
+    
+    /* Unfinished tasks without a reached limit mean every worker failed
+     * to allocate: report failure like the serial search does */
+    bool leftover = false;
+    for (int w = 0; w < workers; w++) {
+        TaskDeque *deque = &shared->deques[w];
+        if (deque->bottom > deque->top) leftover = true;
+        if (shared->stats) search_stats_merge(shared->stats, &states[w].stats);
+        pthread_mutex_destroy(&deque->lock);
+    }
+    if (leftover && result < shared->max_solutions) {
+        result = 0;
+    }
+    
+cleanup:
+    free(items);
+    free(started);
+    free(threads);
+    free(states);
+    free(shared->deques);
+    return result;
+}
+
+static int parallel_count_solutions(const Board *board, int max_solutions,
+                                    int threads, bool prune, SearchStats *stats) {
+    if (threads <= 1) {
+        return grid_count_solutions(board, max_solutions, prune, 0, stats);
+    }
+    
+    if (!board || !board->cells || max_solutions <= 0) {
+        return 0;
+    }
+    
+    int start_row, start_col;
+    if (!board_find_number(board, 1, &start_row, &start_col)) {
+        return 0;
+    }
+    
+    CountSearch search;
+    if (!count_search_init(&search, board, max_solutions, prune, stats)) {
+        return 0;
+    }
+    
+    int count = 0;
+    TaskLevel level = {0, 1, NULL, NULL};
+    
+    if (prune && !root_is_feasible(&search)) {
+        goto done;
+    }
+    
+    int start = board_index(board, start_row, start_col);
+    search.visited[start] = true;
+    bool root = dfs_enter(&search, -1, start, 2, 1);
+    search.visited[start] = false;
+    
+    if (root) {
+        if (stats) search_stats_node(stats, 0);
+        if (!task_level_alloc(&level, 1, 1)) {
+            goto done;
+        }
+        level.paths[0] = start;
+        level.next_numbers[0] = 2;
+        level.count = 1;
+    }
+    
+    /* Expand breadth-first until every worker has several subtrees */
+    while (level.count > 0 &&
+           level.count < threads * SPLIT_TASKS_PER_THREAD &&
+           level.length < SPLIT_MAX_DEPTH &&
+           !dfs_done(&search)) {
+        TaskLevel next;
+        if (!split_level(&search, &level, &next)) {
+            task_level_free(&level);
+            goto done;
+        }
+        task_level_free(&level);
+        level = next;
+    }
+    
+    count = search.solution_count;
+    if (level.count > 0 && !dfs_done(&search)) {
+        ParallelCount shared;
+        shared.board = board;
+        shared.max_solutions = max_solutions;
+        shared.prune = prune;
+        shared.tasks = &level;
+        shared.worker_count = threads < level.count ? threads : level.count;
+        shared.stats = stats;
+        count = run_count_workers(&shared, count);
+    }
+    task_level_free(&level);
+    
+done:
+    count_search_free(&search);
+    return count < max_solutions ? count : max_solutions;
+}
+
+int puzzle_count_solutions_parallel(const Board *board, int max_solutions,
+                                    int threads) {
+    return parallel_count_solutions(board, max_solutions, threads, true, NULL);
+}
+
+int puzzle_count_solutions_ex(const Board *board, int max_solutions,
+                              const SolverOptions *options,
+                              SearchStats *stats) {
+    SolverEngine engine = options ? options->engine : SOLVER_ENGINE_AUTO;
+    bool prune = !(options && options->disable_pruning);
+    int threads = options ? options->threads : 1;
+    size_t table_bytes = SOLVER_DEFAULT_TABLE_BYTES;
+    
+    if (options && options->disable_table) {
+        table_bytes = 0;
+    } else if (options && options->table_bytes > 0) {
+        table_bytes = options->table_bytes;
+    }
+    
+    if (threads > 1) {
+        return parallel_count_solutions(board, max_solutions, threads,
+                                        prune, stats);
+    }
+    
+    switch (engine) {
+        case SOLVER_ENGINE_AUTO:
+        case SOLVER_ENGINE_GRID:
+        default:
+            return grid_count_solutions(board, max_solutions, prune,
+                                        table_bytes, stats);
+    }
+}
+
+int puzzle_count_solutions(const Board *board, int max_solutions) {
+    return puzzle_count_solutions_ex(board, max_solutions, NULL, NULL);
+}
+
+int puzzle_count_solutions_avoiding(const Board *board, int max_solutions,
+                                    int row, int col, int number,
+                                    SearchStats *stats) {
+    if (!board || row < 0 || row >= board->height ||
+        col < 0 || col >= board->width) {
+        return 0;
+    }
+    
+    CountSearch search;
+    if (!grid_search_open(&search, board, max_solutions, true, stats)) {
+        return 0;
+    }
+    search.forbid_pos = board_index(board, row, col);
+    search.forbid_number = number;
+    search.table_bytes = SOLVER_DEFAULT_TABLE_BYTES;
+    
+    int solution_count = grid_count_search(&search);
+    count_search_free(&search);
+    return solution_count;
+}
+
+int puzzle_count_solutions_witness(const Board *board, int max_solutions,
+                                   int *witness, int *witness_length,
+                                   SearchStats *stats) {
+    if (witness_length) *witness_length = 0;
+    if (!witness) {
+        return puzzle_count_solutions_ex(board, max_solutions, NULL, stats);
+    }
+    
+    CountSearch search;
+    if (!grid_search_open(&search, board, max_solutions, true, stats)) {
+        return 0;
+    }
+    search.witness = witness;
+    
+    int solution_count = grid_count_search(&search);
+    if (witness_length) *witness_length = search.witness_length;
+    count_search_free(&search);
+    return solution_count;
+}
+
+int puzzle_count_solutions_from_state(const GameState *state, int max_solutions,
+                                      int *witness, int *witness_length,
+                                      SearchStats *stats) {
+    if (witness_length) *witness_length = 0;
+    if (!state || state->player.next_number > state->board->max_number) {
+        return 0;
+    }
+    
+    CountSearch search;
+    if (!grid_search_open(&search, state->board, max_solutions, true, stats)) {
+        return 0;
+    }
+    search.witness = witness;
+    
+    /* The cells already walked are the prefix the search resumes from.
+     * No table: its hits add counts without a witness path. */
+    const Board *board = state->board;
+    int path_length = 0;
+    for (int i = 0; i < board_cell_count(board); i++) {
+        if (state->visited[i]) {
+            search.visited[i] = true;
+            path_length++;
+        }
+    }
+    
+    int start = board_index(board, state->player.row, state->player.col);
+    int next_number = state->player.next_number;
+    search.visited[start] = true;
+    search.base_depth = path_length - 1;
+    
+    if (dfs_enter(&search, -1, start, next_number, path_length)) {
+        if (stats) count_node(&search, search.base_depth);
+        dfs_count_from(&search, start, next_number);
+    }
+    
+    int solution_count = count_search_result(&search);
+    if (witness_length) *witness_length = search.witness_length;
+    count_search_free(&search);
+    return solution_count;
+}
+
+int puzzle_enumerate_solutions(const Board *board, int max_solutions,
+                               SolutionCallback callback, void *user) {
+    if (!callback) {
+        return 0;
+    }
+    if (max_solutions <= 0) {
+        max_solutions = INT_MAX;
+    }
+    
+    CountSearch search;
+    if (!grid_search_open(&search, board, max_solutions, true, NULL)) {
+        return 0;
+    }
+    
+    /* One move buffer for the whole enumeration, refilled per solution */
+    search.moves = (char *)malloc(board_cell_count(board));
+    if (!search.moves) {
+        count_search_free(&search);
+        return 0;
+    }
+    search.on_solution = callback;
+    search.user = user;
+    
+    grid_count_search(&search);
+    
+    int delivered = search.delivered;
+    free(search.moves);
+    count_search_free(&search);
+    return delivered;
+}
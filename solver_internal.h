@@ -0,0 +1,142 @@
+/*
+ * solver_internal.h - Pruning Rules Shared by the Counter and the Rater
+ *
+ * Internal to solver_count.c and difficulty.c. Each rule lives here
+ * once, so the counter and the difficulty rater (which relies on never
+ * striking out a move the counter would keep) cannot drift apart.
+ */
+
+#ifndef SOLVER_INTERNAL_H
+#define SOLVER_INTERNAL_H
+
+#include "engine.h"
+#include <string.h>
+
+/* ============================================================================
+ * SPLIT TEST
+ * ============================================================================ */
+
+/* Offsets of the 8 cells around a cell: N, NE, E, SE, S, SW, W, NW, so
+ * neighbors in this order touch */
+static inline void solver_ring_offsets(const Board *board, int ring[8]) {
+    const int offsets[8] = {
+        -board->stride, -board->stride + 1, 1, board->stride + 1,
+        board->stride, board->stride - 1, -1, -board->stride - 1
+    };
+    memcpy(ring, offsets, sizeof(offsets));
+}
+
+/*
+ * Cheap local test run before a full reachability check. When the path
+ * steps from prev onto pos, the only cells that can drop out of reach are
+ * the free orthogonal neighbors of prev. If they all lie in one run of
+ * free cells around prev's 8-ring (counting pos as free), they are still
+ * connected to pos and no later number can have been cut off.
+ *
+ * ring has bit k set when ring cell k (solver_ring_offsets() order) is
+ * free. A run starts where a free cell follows a blocked one; only runs
+ * holding an orthogonal neighbor (even k) count.
+ */
+static inline bool solver_ring_may_split(unsigned ring) {
+    int runs = 0;
+    for (int k = 0; k < 8; k++) {
+        bool start = ((ring >> k) & 1) && !((ring >> ((k + 7) % 8)) & 1);
+        if (!start) continue;
+
+        bool has_orthogonal = false;
+        for (int j = k; (ring >> (j % 8)) & 1; j++) {
+            if (j % 2 == 0) has_orthogonal = true;
+        }
+        runs += has_orthogonal;
+    }
+    return runs > 1;
+}
+
+/* solver_ring_may_split() with free meaning non-wall and not visited */
+static inline bool solver_step_may_split(const Board *board, const int ring[8],
+                                         const bool *visited, int prev, int pos) {
+    unsigned mask = 0;
+    for (int k = 0; k < 8; k++) {
+        int c = prev + ring[k];
+        if (c == pos || (board->cells[c].type != CELL_WALL && !visited[c])) {
+            mask |= 1u << k;
+        }
+    }
+    return solver_ring_may_split(mask);
+}
+
+/* ============================================================================
+ * REACHABILITY
+ * ============================================================================ */
+
+/* BFS scratch: generation stamps and a queue, board_cell_count() each */
+typedef struct {
+    unsigned *seen;
+    int *queue;
+    unsigned generation;
+} SolverReach;
+
+/*
+ * BFS from head over unvisited non-wall cells.
+ *
+ * With target >= 0 only blank cells are entered (a path segment cannot
+ * cross a number other than the one it heads for), skipping forbid (-1
+ * for none), and the search stops when target is touched. With target
+ * < 0 number cells are entered too, and the search succeeds once left
+ * cells have been seen: the unvisited numbers, or under full coverage
+ * (coverage true) every unvisited open cell.
+ */
+static inline bool solver_head_reaches(SolverReach *r, const Board *board,
+                                       const bool *visited, bool coverage,
+                                       int head, int target, int forbid, int left) {
+    if (++r->generation == 0) {
+        /* Stamps wrapped: start over from a clean slate */
+        memset(r->seen, 0, board_cell_count(board) * sizeof(unsigned));
+        r->generation = 1;
+    }
+
+    int head_idx = 0, tail_idx = 0;
+    r->queue[tail_idx++] = head;
+    r->seen[head] = r->generation;
+
+    while (head_idx < tail_idx) {
+        int pos = r->queue[head_idx++];
+
+        for (unsigned moves = board->open_dirs[pos]; moves; moves &= moves - 1) {
+            int next = pos + board->delta[__builtin_ctz(moves)];
+            bool number = board->cells[next].type == CELL_NUMBER;
+
+            if (next == target) return true;
+            if (r->seen[next] == r->generation || visited[next]) continue;
+            if (target >= 0 && next == forbid) continue;
+
+            r->seen[next] = r->generation;
+            if (number && target >= 0) continue;
+            if ((number || coverage) && target < 0 && --left == 0) return true;
+            r->queue[tail_idx++] = next;
+        }
+    }
+
+    return target < 0 && left == 0;
+}
+
+/* ============================================================================
+ * COVERAGE
+ * ============================================================================ */
+
+/*
+ * Full coverage: free neighbors of an unvisited open cell, the path head
+ * counting as free. It needs two (a way in and a way out) unless it is
+ * the last number, where the path ends and one will do.
+ */
+static inline int solver_free_neighbors(const Board *board, const bool *visited,
+                                        int cell, int head) {
+    int open = 0;
+    for (unsigned moves = board->open_dirs[cell]; moves; moves &= moves - 1) {
+        int n = cell + board->delta[__builtin_ctz(moves)];
+        if (n == head || !visited[n]) open++;
+    }
+    return open;
+}
+
+#endif /* SOLVER_INTERNAL_H */
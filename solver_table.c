@@ -0,0 +1,99 @@
+/*
+ * solver_table.c - Transposition Table Implementation
+ */
+
+#include "solver_table.h"
+#include "rng.h"
+#include <stdlib.h>
+
+#define TABLE_WAYS 2
+
+/* Fixed so that runs are reproducible; any seed works */
+#define TABLE_KEY_SEED 0x5A17C0DEull
+
+static size_t bucket_count(size_t budget_bytes) {
+    size_t buckets = 1;
+    if (budget_bytes < TABLE_WAYS * sizeof(TableEntry)) {
+        return 0;
+    }
+    while (buckets * 2 * TABLE_WAYS * sizeof(TableEntry) <= budget_bytes) {
+        buckets *= 2;
+    }
+    return buckets;
+}
+
+size_t solver_table_bytes(int cells, size_t budget_bytes) {
+    return bucket_count(budget_bytes) * TABLE_WAYS * sizeof(TableEntry) +
+           (size_t)cells * (sizeof(uint64_t) + sizeof(TableFrame));
+}
+
+void solver_table_free(SolverTable *table) {
+    free(table->entries);
+    free(table->cell_keys);
+    free(table->frames);
+    table->entries = NULL;
+    table->cell_keys = NULL;
+    table->frames = NULL;
+}
+
+bool solver_table_init(SolverTable *table, int cells, size_t budget_bytes) {
+    size_t buckets = bucket_count(budget_bytes);
+
+    table->entries = NULL;
+    table->cell_keys = NULL;
+    table->frames = NULL;
+    if (buckets == 0) {
+        return false;
+    }
+
+    table->bucket_mask = buckets - 1;
+    table->entries = (TableEntry *)calloc(buckets * TABLE_WAYS, sizeof(TableEntry));
+    table->cell_keys = (uint64_t *)malloc(cells * sizeof(uint64_t));
+    table->frames = (TableFrame *)malloc(cells * sizeof(TableFrame));
+    if (!table->entries || !table->cell_keys || !table->frames) {
+        solver_table_free(table);
+        return false;
+    }
+
+    Rng rng;
+    rng_seed(&rng, TABLE_KEY_SEED);
+    for (int i = 0; i < cells; i++) {
+        table->cell_keys[i] = rng_next(&rng);
+    }
+
+    return true;
+}
+
+static TableEntry *bucket_of(const SolverTable *table, uint64_t key) {
+    /* The low bit of every key is set, so index from the high bits */
+    return table->entries + ((size_t)(key >> 24) & table->bucket_mask) * TABLE_WAYS;
+}
+
+bool solver_table_probe(const SolverTable *table, uint64_t key, int *count) {
+    const TableEntry *bucket = bucket_of(table, key);
+
+    for (int way = 0; way < TABLE_WAYS; way++) {
+        if (bucket[way].key == key) {
+            *count = bucket[way].count;
+            return true;
+        }
+    }
+    return false;
+}
+
+void solver_table_store(SolverTable *table, uint64_t key, int count,
+                        unsigned long work) {
+    TableEntry *bucket = bucket_of(table, key);
+    TableEntry entry = {key, count, work > UINT32_MAX ? UINT32_MAX : (uint32_t)work};
+
+    /* Way 0 keeps the costliest subtree seen; whatever it displaces (or
+     * whatever fails to displace it) goes to way 1, which always yields */
+    if (bucket[0].key == key || entry.work >= bucket[0].work) {
+        if (bucket[0].key != key && bucket[1].key != key) {
+            bucket[1] = bucket[0];
+        }
+        bucket[0] = entry;
+    } else {
+        bucket[1] = entry;
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * solver_table.h - Transposition Table for Solution Counting
+ *
+ * Different move orders often bring the counter to the same head cell,
+ * heading for the same number, with the same cells visited. Everything
+ * below that point is then identical, so the subtree's solution count
+ * can be stored once and reused.
+ *
+ * Keys are Zobrist hashes: every cell has a random 64-bit key, the
+ * visited set hashes to the XOR of its cells' keys (updated with one XOR
+ * per step), and the head and next number are mixed in on top.
+ *
+ * Memory is fixed at creation. Buckets hold two entries: one keeps the
+ * entry whose subtree took the most nodes to count, the other always
+ * takes the newest, so expensive results survive a stream of cheap ones.
+ *
+ * Internal to the GRID counting engine (solver_count.c).
+ */
+
+#ifndef SOLVER_TABLE_H
+#define SOLVER_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A search turns the table on only after expanding this many nodes, so
+ * the quick uniqueness checks that make up most calls never pay for it
+ */
+#define SOLVER_TABLE_MIN_NODES 4096
+
+typedef struct {
+    uint64_t key;       /* 0 marks an empty entry */
+    int count;          /* solutions below, capped at the search limit */
+    uint32_t work;      /* nodes the subtree took (saturating) */
+} TableEntry;
+
+/* Per-depth bookkeeping for the frame whose subtree is being counted */
+typedef struct {
+    uint64_t key;       /* 0: frame predates the table, do not store */
+    int count;          /* solution count when the frame was entered */
+    unsigned long nodes;
+} TableFrame;
+
+typedef struct {
+    TableEntry *entries;    /* 2 * (bucket_mask + 1) entries */
+    size_t bucket_mask;
+    uint64_t *cell_keys;    /* Zobrist key per padded board cell */
+    TableFrame *frames;     /* one per possible path cell */
+} SolverTable;
+
+/*
+ * Allocate a table for a board of cells padded cells, using at most
+ * budget_bytes for entries (rounded down to a power-of-two bucket count).
+ * Returns false on allocation failure or a budget below one bucket.
+ */
+bool solver_table_init(SolverTable *table, int cells, size_t budget_bytes);
+
+void solver_table_free(SolverTable *table);
+
+/*
+ * Bytes solver_table_init() allocates for this board and budget
+ */
+size_t solver_table_bytes(int cells, size_t budget_bytes);
+
+/*
+ * Key of the state (visited set, head, next number); never 0
+ */
+static inline uint64_t solver_table_key(const SolverTable *table,
+                                        uint64_t visited_hash,
+                                        int head, int next_number) {
+    uint64_t head_key = table->cell_keys[head];
+    head_key = head_key << 29 | head_key >> 35;
+    return (visited_hash ^ head_key ^
+            (uint64_t)next_number * 0x9E3779B97F4A7C15ull) | 1;
+}
+
+/*
+ * Stored count for key, if present
+ */
+bool solver_table_probe(const SolverTable *table, uint64_t key, int *count);
+
+/*
+ * Store a finished subtree's count (see the replacement policy above)
+ */
+void solver_table_store(SolverTable *table, uint64_t key, int count,
+                        unsigned long work);
+
+#endif /* SOLVER_TABLE_H */
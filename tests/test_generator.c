@@ -0,0 +1,124 @@
+/*
+ * test_generator.c - Path Generation Regression Test
+ *
+ * Pins down what generate_puzzle() promises: numbers 1..N run along a
+ * simple path of adjacent cells (so every board is solvable), and a seed
+ * gives the same board from build to build. The expected hashes change
+ * only when the walk deliberately changes.
+ *
+ * Built and run by `make check`.
+ */
+
+#include "generator.h"
+#include "solver_count.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+/* FNV-1a over the shape, the rules and every cell */
+static uint64_t board_hash(const Board *board) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    int values[] = {board->height, board->width, (int)board->rules};
+    for (int k = 0; k < 3; k++) {
+        hash = (hash ^ (uint64_t)values[k]) * 0x100000001B3ull;
+    }
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            const Cell *cell = board_cell(board, i, j);
+            hash = (hash ^ (uint64_t)cell->type) * 0x100000001B3ull;
+            hash = (hash ^ (uint64_t)cell->number) * 0x100000001B3ull;
+        }
+    }
+    return hash;
+}
+
+/* Consecutive numbers sit on orthogonally adjacent cells */
+static bool numbers_adjacent(const Board *board) {
+    for (int n = 1; n < board->max_number; n++) {
+        int from = board_number_index(board, n);
+        int to = board_number_index(board, n + 1);
+        if (from < 0 || to < 0) return false;
+        int distance = abs(board_index_row(board, from) - board_index_row(board, to)) +
+                       abs(board_index_col(board, from) - board_index_col(board, to));
+        if (distance != 1) return false;
+    }
+    return true;
+}
+
+static void test_paths_are_simple(void) {
+    static const int sizes[] = {6, 10, 15, 25};
+    static const float path_ratios[] = {0.3f, 0.5f, 0.8f};
+
+    for (int s = 0; s < 4; s++) {
+        for (int p = 0; p < 3; p++) {
+            for (unsigned seed = 0; seed < 50; seed++) {
+                Board *board = generate_puzzle(sizes[s], sizes[s], path_ratios[p],
+                                               0.3f, seed);
+                if (!board) continue;
+                CHECK(numbers_adjacent(board), "%dx%d path %.1f seed %u: numbers not adjacent",
+                      sizes[s], sizes[s], path_ratios[p], seed);
+                CHECK(puzzle_count_solutions(board, 1) == 1,
+                      "%dx%d path %.1f seed %u: no solution",
+                      sizes[s], sizes[s], path_ratios[p], seed);
+                board_free(board);
+            }
+        }
+    }
+}
+
+static void test_seeds_are_stable(void) {
+    static const struct {
+        int rows, cols;
+        float path_ratio, wall_ratio;
+        unsigned seed;
+        uint64_t hash;
+    } golden[] = {
+        {8, 8, 0.5f, 0.2f, 1, 0x7157C3EB72635C37ull},
+        {10, 10, 0.5f, 0.2f, 42, 0x4EBF73C6295282D3ull},
+        {15, 15, 0.8f, 0.3f, 7, 0x8788C06F44E9F869ull},
+        {20, 12, 0.3f, 0.6f, 123, 0x28B2DC8FEBA0173Full},
+    };
+
+    for (size_t k = 0; k < sizeof(golden) / sizeof(golden[0]); k++) {
+        Board *board = generate_puzzle(golden[k].rows, golden[k].cols,
+                                       golden[k].path_ratio, golden[k].wall_ratio,
+                                       golden[k].seed);
+        CHECK(board != NULL, "golden %zu: no board", k);
+        if (!board) continue;
+        uint64_t hash = board_hash(board);
+        CHECK(hash == golden[k].hash, "golden %zu: board hash %016" PRIx64, k, hash);
+        board_free(board);
+    }
+
+    Board *board = generate_coverage_puzzle(10, 10, 0.6f, 5);
+    CHECK(board != NULL, "coverage: no board");
+    if (board) {
+        uint64_t hash = board_hash(board);
+        CHECK(hash == 0xBD8076B39914A6B5ull, "coverage: board hash %016" PRIx64, hash);
+        CHECK(puzzle_count_solutions(board, 1) == 1, "coverage: no solution");
+        board_free(board);
+    }
+}
+
+int main(void) {
+    test_paths_are_simple();
+    test_seeds_are_stable();
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_generator: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,309 @@
+/*
+ * test_puzzle_pack.c - Puzzle Pack Round-Trip and Validation Test
+ *
+ * Boards written with pack_writer_add() come back from puzzle_pack_load()
+ * cell for cell, rules included, through one reused Board, and stored
+ * solutions come back key for key. Damaged packs are refused: a bad
+ * header or a truncated index at open, a corrupt record or an index out
+ * of range at load, while the other records still load.
+ *
+ * Built and run by `make check`.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "generator.h"
+#include "puzzle_pack.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+#define PUZZLE_COUNT 6
+
+static char pack_path[] = "/tmp/test_puzzle_pack_XXXXXX";
+static char bad_path[] = "/tmp/test_puzzle_pack_bad_XXXXXX";
+
+/* ============================================================================
+ * HELPERS
+ * ============================================================================ */
+
+/* Keys walking numbers 1..max_number (generated boards number every step) */
+static int solution_keys(const Board *board, char *keys) {
+    int count = 0;
+    for (int n = 1; n < board->max_number; n++) {
+        int step = board_number_index(board, n + 1) - board_number_index(board, n);
+        if (step == board->delta[BOARD_UP]) keys[count++] = 'w';
+        else if (step == board->delta[BOARD_DOWN]) keys[count++] = 's';
+        else if (step == board->delta[BOARD_LEFT]) keys[count++] = 'a';
+        else keys[count++] = 'd';
+    }
+    return count;
+}
+
+static bool same_board(const Board *a, const Board *b) {
+    if (a->height != b->height || a->width != b->width || a->rules != b->rules ||
+        a->max_number != b->max_number) return false;
+    for (int i = 0; i < a->height; i++) {
+        for (int j = 0; j < a->width; j++) {
+            const Cell *x = board_cell(a, i, j);
+            const Cell *y = board_cell(b, i, j);
+            if (x->type != y->type) return false;
+            if (x->type == CELL_NUMBER && x->number != y->number) return false;
+        }
+    }
+    return true;
+}
+
+static unsigned char *read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *data = (unsigned char *)malloc(*size);
+    if (data && fread(data, *size, 1, file) != 1) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+static void write_file(const char *path, const unsigned char *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return;
+    fwrite(data, size, 1, file);
+    fclose(file);
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int k = 7; k >= 0; k--) v = v << 8 | p[k];
+    return v;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    for (int k = 0; k < 4; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+/* ============================================================================
+ * TESTS
+ * ============================================================================ */
+
+static Board *boards[PUZZLE_COUNT];
+static char *solutions[PUZZLE_COUNT];
+static int move_counts[PUZZLE_COUNT];
+
+static void make_boards(void) {
+    for (int k = 0; k < PUZZLE_COUNT; k++) {
+        if (k == 4) {
+            boards[k] = generate_coverage_puzzle(7, 7, 0.6f, 3);
+        } else {
+            boards[k] = generate_puzzle(6 + k, 10 - k, 0.5f, 0.3f, (unsigned)k);
+        }
+        solutions[k] = NULL;
+        move_counts[k] = 0;
+        if (boards[k] && k % 2 == 0) {
+            solutions[k] = (char *)malloc((size_t)boards[k]->height * boards[k]->width);
+            move_counts[k] = solution_keys(boards[k], solutions[k]);
+        }
+    }
+}
+
+static void test_round_trip(void) {
+    PackWriter *writer = pack_writer_open(pack_path);
+    CHECK(writer != NULL, "cannot open %s", pack_path);
+    if (!writer) return;
+
+    for (int k = 0; k < PUZZLE_COUNT; k++) {
+        CHECK(boards[k] && pack_writer_add(writer, boards[k], solutions[k], move_counts[k]),
+              "add %d", k);
+    }
+
+    /* Rejected boards leave the writer usable */
+    Board *big = board_create(5, 5);
+    board_set_number(big, 0, 0, 1);
+    board_set_number(big, 4, 4, PACK_MAX_NUMBER + 1);
+    errno = 0;
+    CHECK(!pack_writer_add(writer, big, NULL, 0) && errno == EOVERFLOW,
+          "number past PACK_MAX_NUMBER accepted");
+    board_free(big);
+    errno = 0;
+    CHECK(!pack_writer_add(writer, boards[0], "wx", 2) && errno == EINVAL,
+          "bad solution key accepted");
+
+    CHECK(pack_writer_close(writer), "close");
+
+    PuzzlePack *pack = puzzle_pack_open(pack_path);
+    CHECK(pack != NULL, "open");
+    if (!pack) return;
+    CHECK(puzzle_pack_count(pack) == PUZZLE_COUNT, "count %d", puzzle_pack_count(pack));
+
+    Board *view = puzzle_pack_board_create(pack);
+    char *moves = (char *)malloc((size_t)view->height * view->width);
+    for (int pass = 0; pass < 2; pass++) {
+        /* Backwards on the second pass: every load replaces a larger or
+         * smaller board than the last */
+        for (int i = 0; i < PUZZLE_COUNT; i++) {
+            int k = pass ? PUZZLE_COUNT - 1 - i : i;
+            CHECK(puzzle_pack_load(pack, k, view), "load %d", k);
+            CHECK(same_board(view, boards[k]), "puzzle %d differs after reload", k);
+
+            int count = puzzle_pack_solution(pack, k, moves);
+            if (solutions[k]) {
+                CHECK(count == move_counts[k] &&
+                      memcmp(moves, solutions[k], (size_t)count) == 0,
+                      "puzzle %d: solution differs", k);
+            } else {
+                CHECK(count == -1, "puzzle %d: solution %d, none stored", k, count);
+            }
+        }
+    }
+
+    CHECK(!puzzle_pack_load(pack, -1, view), "index -1 loaded");
+    CHECK(!puzzle_pack_load(pack, PUZZLE_COUNT, view), "index past the end loaded");
+    CHECK(puzzle_pack_solution(pack, PUZZLE_COUNT, moves) == -1,
+          "solution past the end");
+
+    free(moves);
+    board_free(view);
+    puzzle_pack_close(pack);
+}
+
+/* Offset of record index in a pack image */
+static size_t record_offset(const unsigned char *data, int index) {
+    return (size_t)get_u64(data + get_u64(data + 16) + 8 * (size_t)index);
+}
+
+/* Write data with one record damaged; it must fail to load, others not */
+static void check_corrupt_record(const unsigned char *good, size_t size,
+                                 const char *what, int index,
+                                 void (*damage)(unsigned char *record)) {
+    unsigned char *data = (unsigned char *)malloc(size);
+    memcpy(data, good, size);
+    damage(data + record_offset(data, index));
+    write_file(bad_path, data, size);
+    free(data);
+
+    PuzzlePack *pack = puzzle_pack_open(bad_path);
+    CHECK(pack != NULL, "%s: pack refused at open", what);
+    if (!pack) return;
+
+    Board *view = puzzle_pack_board_create(pack);
+    CHECK(!puzzle_pack_load(pack, index, view), "%s: record loaded", what);
+    int other = index == 0 ? 1 : 0;
+    CHECK(puzzle_pack_load(pack, other, view) && same_board(view, boards[other]),
+          "%s: record %d no longer loads", what, other);
+    board_free(view);
+    puzzle_pack_close(pack);
+}
+
+static void zero_height(unsigned char *record) { record[0] = record[1] = 0; }
+static void bad_rules(unsigned char *record) { record[4] = 7; }
+static void too_many_numbers(unsigned char *record) { put_u32(record + 8, 0xFFFF); }
+static void long_solution(unsigned char *record) { put_u32(record + 12, 60); }
+static void bad_cell_type(unsigned char *record) { record[16] |= 3; }
+
+static void test_corrupt_packs(void) {
+    size_t size;
+    unsigned char *good = read_file(pack_path, &size);
+    CHECK(good != NULL, "cannot read %s", pack_path);
+    if (!good) return;
+
+    check_corrupt_record(good, size, "zero height", 1, zero_height);
+    check_corrupt_record(good, size, "rules out of range", 2, bad_rules);
+    check_corrupt_record(good, size, "number count past the cells", 0, too_many_numbers);
+    check_corrupt_record(good, size, "solution past the record", 2, long_solution);
+    check_corrupt_record(good, size, "cell type 3", 3, bad_cell_type);
+
+    /* Header and index damage is refused at open */
+    unsigned char *data = (unsigned char *)malloc(size);
+    static const struct {
+        const char *what;
+        size_t offset;
+        unsigned char value;
+    } header_damage[] = {
+        {"bad magic", 0, 'X'},
+        {"version 2", 4, 2},
+        {"puzzle count past the index", 8, 0x7F},
+        {"index offset past the end", 23, 0x7F},
+    };
+    for (size_t k = 0; k < sizeof(header_damage) / sizeof(header_damage[0]); k++) {
+        memcpy(data, good, size);
+        data[header_damage[k].offset] = header_damage[k].value;
+        write_file(bad_path, data, size);
+        PuzzlePack *pack = puzzle_pack_open(bad_path);
+        CHECK(pack == NULL, "%s: pack opened", header_damage[k].what);
+        puzzle_pack_close(pack);
+    }
+
+    write_file(bad_path, good, size - 4);
+    PuzzlePack *pack = puzzle_pack_open(bad_path);
+    CHECK(pack == NULL, "truncated index: pack opened");
+    puzzle_pack_close(pack);
+
+    write_file(bad_path, good, 10);
+    pack = puzzle_pack_open(bad_path);
+    CHECK(pack == NULL, "file shorter than the header: pack opened");
+    puzzle_pack_close(pack);
+
+    /* An index entry pointing backwards makes a record of negative size */
+    memcpy(data, good, size);
+    size_t index = (size_t)get_u64(data + 16);
+    memcpy(data + index + 8, data + index + 16, 8);
+    write_file(bad_path, data, size);
+    pack = puzzle_pack_open(bad_path);
+    CHECK(pack != NULL, "swapped index: pack refused at open");
+    if (pack) {
+        Board *view = puzzle_pack_board_create(pack);
+        CHECK(!puzzle_pack_load(pack, 1, view), "swapped index: record 1 loaded");
+        board_free(view);
+        puzzle_pack_close(pack);
+    }
+
+    free(data);
+    free(good);
+}
+
+int main(void) {
+    int fd = mkstemp(pack_path);
+    int bad_fd = mkstemp(bad_path);
+    if (fd < 0 || bad_fd < 0) {
+        printf("cannot create temporary files\n");
+        return 1;
+    }
+    close(fd);
+    close(bad_fd);
+
+    make_boards();
+    test_round_trip();
+    test_corrupt_packs();
+
+    for (int k = 0; k < PUZZLE_COUNT; k++) {
+        board_free(boards[k]);
+        free(solutions[k]);
+    }
+    unlink(pack_path);
+    unlink(bad_path);
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_puzzle_pack: all checks passed\n");
+    return 0;
+}
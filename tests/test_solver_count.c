@@ -0,0 +1,208 @@
+/*
+ * test_solver_count.c - Solution Counter Agreement Test
+ *
+ * Every way of running the counter must return the same count as the
+ * plain serial search (GRID, no pruning, no table): pruning, the
+ * transposition table (default size and a tiny one that keeps evicting),
+ * and the parallel counter on 2 and 4 threads. Boards come with many
+ * solutions as well as one, under both rule modes, and each is counted
+ * with max_solutions 1, 2 and a limit no board reaches. A node budget
+ * (SearchStats node_limit) that runs out turns the count into -1.
+ *
+ * Built and run by `make check`.
+ */
+
+#include "generator.h"
+#include "solver_count.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int failures = 0;
+static int comparisons = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+#define LIMIT_LARGE 1000000
+
+static const struct {
+    const char *name;
+    SolverOptions options;
+} variants[] = {
+    {"auto", {SOLVER_ENGINE_AUTO, false, 1, false, 0}},
+    {"pruned, no table", {SOLVER_ENGINE_GRID, false, 1, true, 0}},
+    {"pruned, table", {SOLVER_ENGINE_GRID, false, 1, false, 0}},
+    {"pruned, tiny table", {SOLVER_ENGINE_GRID, false, 1, false, 256}},
+    {"unpruned, table", {SOLVER_ENGINE_GRID, true, 1, false, 0}},
+    {"parallel 2", {SOLVER_ENGINE_GRID, false, 2, false, 0}},
+    {"parallel 4", {SOLVER_ENGINE_GRID, false, 4, false, 0}},
+    {"parallel 4, unpruned", {SOLVER_ENGINE_GRID, true, 4, false, 0}},
+};
+
+#define VARIANT_COUNT ((int)(sizeof(variants) / sizeof(variants[0])))
+
+/*
+ * Copy of board that keeps its walls but only every step-th number
+ * (plus the first and last), renumbered 1..k: fewer clues, more
+ * solutions
+ */
+static Board *thin_clues(const Board *board, int step, BoardRules rules) {
+    Board *thin = board_create(board->height, board->width);
+    if (!thin) return NULL;
+    board_set_rules(thin, rules);
+
+    int next = 1;
+    for (int n = 1; n <= board->max_number; n++) {
+        if (n != 1 && n != board->max_number && (n - 1) % step != 0) continue;
+        int cell = board_number_index(board, n);
+        board_set_number(thin, board_index_row(board, cell),
+                         board_index_col(board, cell), next++);
+    }
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            if (board_cell(board, i, j)->type == CELL_WALL) {
+                board_set_wall(thin, i, j);
+            }
+        }
+    }
+    return thin;
+}
+
+/* Empty rows x cols board with 1 and 2 in opposite corners */
+static Board *open_board(int rows, int cols, BoardRules rules) {
+    Board *board = board_create(rows, cols);
+    if (!board) return NULL;
+    board_set_rules(board, rules);
+    board_set_number(board, 0, 0, 1);
+    board_set_number(board, rows - 1, cols - 1, 2);
+    return board;
+}
+
+static void compare_counts(const Board *board, const char *label) {
+    static const int limits[] = {1, 2, LIMIT_LARGE};
+    const SolverOptions serial = {SOLVER_ENGINE_GRID, true, 1, true, 0};
+
+    for (int l = 0; l < 3; l++) {
+        int expected = puzzle_count_solutions_ex(board, limits[l], &serial, NULL);
+        CHECK(expected >= 0 && expected <= limits[l], "%s max %d: serial count %d",
+              label, limits[l], expected);
+
+        for (int v = 0; v < VARIANT_COUNT; v++) {
+            int count = puzzle_count_solutions_ex(board, limits[l],
+                                                  &variants[v].options, NULL);
+            CHECK(count == expected, "%s max %d, %s: %d, serial %d",
+                  label, limits[l], variants[v].name, count, expected);
+            comparisons++;
+        }
+
+        int count = puzzle_count_solutions_parallel(board, limits[l], 3);
+        CHECK(count == expected, "%s max %d, parallel 3: %d, serial %d",
+              label, limits[l], count, expected);
+        comparisons++;
+    }
+}
+
+static void test_generated_boards(void) {
+    char label[96];
+
+    for (unsigned seed = 0; seed < 12; seed++) {
+        Board *board = generate_puzzle(6, 6, 0.6f, 0.2f, seed);
+        if (!board) continue;
+
+        for (int step = 1; step <= 4; step++) {
+            Board *thin = thin_clues(board, step, RULES_REACH_LAST);
+            if (!thin) continue;
+            snprintf(label, sizeof(label), "6x6 seed %u, every %d clue(s)", seed, step);
+            compare_counts(thin, label);
+            board_free(thin);
+        }
+        board_free(board);
+
+        board = generate_coverage_puzzle(5, 5, 0.6f, seed);
+        if (!board) continue;
+        for (int step = 1; step <= 6; step += 5) {
+            Board *thin = thin_clues(board, step, RULES_FULL_COVERAGE);
+            if (!thin) continue;
+            snprintf(label, sizeof(label), "5x5 coverage seed %u, every %d clue(s)",
+                     seed, step);
+            compare_counts(thin, label);
+            board_free(thin);
+        }
+        board_free(board);
+    }
+}
+
+static void test_open_boards(void) {
+    static const struct {
+        int rows, cols;
+        BoardRules rules;
+        int solutions;
+    } open[] = {
+        /* Self-avoiding corner-to-corner walks, and Hamiltonian ones */
+        {4, 4, RULES_REACH_LAST, 184},
+        {5, 5, RULES_REACH_LAST, 8512},
+        {4, 4, RULES_FULL_COVERAGE, 0},     /* corners share a color */
+        {5, 5, RULES_FULL_COVERAGE, 104},
+    };
+    char label[64];
+
+    for (size_t k = 0; k < sizeof(open) / sizeof(open[0]); k++) {
+        Board *board = open_board(open[k].rows, open[k].cols, open[k].rules);
+        if (!board) continue;
+        snprintf(label, sizeof(label), "open %dx%d %s", open[k].rows, open[k].cols,
+                 open[k].rules == RULES_FULL_COVERAGE ? "coverage" : "reach last");
+        CHECK(puzzle_count_solutions(board, LIMIT_LARGE) == open[k].solutions,
+              "%s: %d solutions, expected %d", label,
+              puzzle_count_solutions(board, LIMIT_LARGE), open[k].solutions);
+        compare_counts(board, label);
+        board_free(board);
+    }
+}
+
+/* A spent node_limit gives -1, unless the limit was reached first */
+static void test_node_budget(void) {
+    Board *board = open_board(5, 5, RULES_REACH_LAST);
+    if (!board) return;
+
+    SearchStats stats;
+    search_stats_reset(&stats);
+    stats.node_limit = 50;
+    int count = puzzle_count_solutions_ex(board, LIMIT_LARGE, NULL, &stats);
+    CHECK(count == -1 && stats.nodes == 50, "budget 50: %d after %ld nodes",
+          count, stats.nodes);
+
+    /* Spent before the call: gives up on its first node */
+    count = puzzle_count_solutions_witness(board, 2, NULL, NULL, &stats);
+    CHECK(count == -1, "spent budget: witness count %d", count);
+
+    search_stats_reset(&stats);
+    stats.node_limit = 1000;
+    count = puzzle_count_solutions_ex(board, 1, NULL, &stats);
+    CHECK(count == 1, "budget 1000, max 1: %d", count);
+
+    search_stats_reset(&stats);
+    stats.node_limit = 10000000;
+    count = puzzle_count_solutions_ex(board, LIMIT_LARGE, NULL, &stats);
+    CHECK(count == 8512, "budget 10000000: %d", count);
+
+    board_free(board);
+}
+
+int main(void) {
+    test_generated_boards();
+    test_open_boards();
+    test_node_budget();
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_solver_count: all %d comparisons passed\n", comparisons);
+    return 0;
+}
@@ -1,66 +1,539 @@
 /*
  * ui_terminal.c - Terminal UI
+ *
+ * Frames are built in one buffer and flushed with a single write(): the
+ * board, then any messages for the turn, then the prompt, sent when
+ * ui_read_keys() starts waiting. The last frame drawn is remembered,
+ * so after the first one only the cells that changed (usually the old
+ * and new player position) are sent, addressed with cursor escapes; the
+ * screen is cleared only when a new board shows up.
+ *
+ * Input is read in raw mode when stdin is a terminal: every byte waiting
+ * is taken at once with poll() and decoded into a batch of keys (arrow
+ * escape sequences included), so the game applies typed-ahead and
+ * repeated keys together and renders once per batch.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "engine.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
 
-void board_render(const Board *board, const GameState *game) {
-    printf("\033[2J\033[H");
+#define HELP_TEXT "WASD to move, U to undo, R to redo, Q to quit"
+
+/* Screen lines (1-based) of the frame */
+#define STATUS_LINE 2
+#define BOARD_LINE 5
+
+/* Longest cell glyph: "%d " of an int */
+#define GLYPH_MAX 13
+
+/* Longest cursor escape plus erase: "\033[%d;%dH" and "\033[K" */
+#define ESCAPE_MAX 32
+
+/* Wait for the rest of an escape sequence split across reads */
+#define ESCAPE_WAIT_MS 25
+
+/* Glyph codes; a number cell not yet visited is its number */
+enum {
+    GLYPH_PLAYER = -1,
+    GLYPH_VISITED = -2,
+    GLYPH_WALL = -3,
+    GLYPH_EMPTY = -4
+};
+
+/* ============================================================================
+ * FRAME STATE
+ * ============================================================================ */
+
+typedef struct {
+    const Board *board;     /* board the glyphs belong to (NULL = none yet) */
+    int height;
+    int width;
+    int next_number;
+    int *glyphs;            /* row-major, height * width */
+    char *buffer;
+    size_t capacity;
+    size_t length;
+} Frame;
+
+static Frame frame;
+
+static int glyph_code(const Board *board, const GameState *game, int row, int col) {
+    if (row == game->player.row && col == game->player.col) {
+        return GLYPH_PLAYER;
+    }
+    if (game->visited[board_index(board, row, col)]) {
+        return GLYPH_VISITED;
+    }
     
-    printf("=== ZIP PUZZLE ===\n");
-    printf("Next number to reach: %d / %d\n", 
-           game->player.next_number, board->max_number);
-    printf("WASD to move, U to undo, Q to quit\n\n");
+    const Cell *cell = board_cell(board, row, col);
+    switch (cell->type) {
+        case CELL_WALL:
+            return GLYPH_WALL;
+        case CELL_NUMBER:
+            return cell->number;
+        default:
+            return GLYPH_EMPTY;
+    }
+}
+
+/* Text of a glyph, trailing space included; returns its length */
+static int glyph_text(int code, char *out) {
+    switch (code) {
+        case GLYPH_PLAYER:
+            memcpy(out, "@ ", 2);
+            return 2;
+        case GLYPH_VISITED:
+            memcpy(out, "* ", 2);
+            return 2;
+        case GLYPH_WALL:
+            memcpy(out, "# ", 2);
+            return 2;
+        case GLYPH_EMPTY:
+            memcpy(out, ". ", 2);
+            return 2;
+        default:
+            return snprintf(out, GLYPH_MAX, "%d ", code);
+    }
+}
+
+/*
+ * Make room for a whole frame up front (every cell redrawn behind its
+ * own cursor escape), so appends need no checks
+ */
+static bool frame_reserve(const Board *board) {
+    size_t cells = (size_t)board->height * board->width;
+    size_t need = 512 + cells * (GLYPH_MAX + ESCAPE_MAX) +
+                  (size_t)board->height * ESCAPE_MAX;
+    
+    if (frame.board != board || frame.height != board->height ||
+        frame.width != board->width) {
+        int *glyphs = (int *)realloc(frame.glyphs, cells * sizeof(int));
+        if (!glyphs) return false;
+        frame.glyphs = glyphs;
+        frame.board = NULL;     /* nothing of this board drawn yet */
+    }
+    
+    if (frame.capacity < need) {
+        char *buffer = (char *)realloc(frame.buffer, need);
+        if (!buffer) return false;
+        frame.buffer = buffer;
+        frame.capacity = need;
+    }
+    
+    frame.length = 0;
+    return true;
+}
+
+static void frame_append(const char *text, size_t length) {
+    memcpy(frame.buffer + frame.length, text, length);
+    frame.length += length;
+}
+
+static void frame_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(frame.buffer + frame.length,
+                      frame.capacity - frame.length, format, args);
+    va_end(args);
+    if (n > 0) frame.length += (size_t)n;
+}
+
+static void frame_glyph(int code) {
+    char text[GLYPH_MAX];
+    frame_append(text, (size_t)glyph_text(code, text));
+}
+
+/* Send the buffer in one write (looping only on a short write) */
+static void frame_flush(void) {
+    /* Whatever stdio still holds goes out first */
+    fflush(stdout);
+    
+    size_t sent = 0;
+    while (sent < frame.length) {
+        ssize_t n = write(STDOUT_FILENO, frame.buffer + sent, frame.length - sent);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        sent += (size_t)n;
+    }
+    frame.length = 0;
+}
+
+/*
+ * Add a line of text to the frame waiting to be sent, or print it when
+ * there is none (the board went out through render_plain())
+ */
+static void frame_message(const char *text) {
+    if (frame.length > 0) {
+        frame_printf("%s", text);
+    } else {
+        fputs(text, stdout);
+    }
+}
+
+/* ============================================================================
+ * RENDERING
+ * ============================================================================ */
+
+static void render_status(const Board *board, const GameState *game) {
+    frame_printf("Next number to reach: %d / %d",
+                 game->player.next_number, board->max_number);
+}
+
+static void render_full(const Board *board, const GameState *game) {
+    frame_printf("\033[2J\033[H=== ZIP PUZZLE ===\n");
+    render_status(board, game);
+    frame_printf("\n" HELP_TEXT "\n\n");
     
     for (int i = 0; i < board->height; i++) {
         for (int j = 0; j < board->width; j++) {
-            if (i == game->player.row && j == game->player.col) {
-                printf("@ ");
-                continue;
-            }
+            int code = glyph_code(board, game, i, j);
+            frame.glyphs[i * board->width + j] = code;
+            frame_glyph(code);
+        }
+        frame_append("\n", 1);
+    }
+    frame_append("\n", 1);
+}
+
+/*
+ * Emit the cells that differ from the last frame. Glyphs are not all one
+ * width, so once a changed cell's width differs the rest of its row
+ * shifts and is redrawn, then erased to the end of the line.
+ */
+static void render_changes(const Board *board, const GameState *game) {
+    if (game->player.next_number != frame.next_number) {
+        frame_printf("\033[%d;1H", STATUS_LINE);
+        render_status(board, game);
+        frame_printf("\033[K");
+    }
+    
+    char text[GLYPH_MAX];
+    for (int i = 0; i < board->height; i++) {
+        int *row = frame.glyphs + i * board->width;
+        int column = 1;
+        
+        for (int j = 0; j < board->width; j++) {
+            int old_width = glyph_text(row[j], text);
+            int code = glyph_code(board, game, i, j);
             
-            if (game->visited[i][j]) {
-                printf("* ");
+            if (code == row[j]) {
+                column += old_width;
                 continue;
             }
             
-            Cell cell = board->grid[i][j];
-            switch (cell.type) {
-                case CELL_WALL:
-                    printf("# ");
-                    break;
-                case CELL_EMPTY:
-                    printf(". ");
-                    break;
-                case CELL_NUMBER:
-                    printf("%d ", cell.number);
-                    break;
+            int width = glyph_text(code, text);
+            row[j] = code;
+            frame_printf("\033[%d;%dH", BOARD_LINE + i, column);
+            frame_append(text, (size_t)width);
+            column += width;
+            
+            if (width != old_width) {
+                for (j++; j < board->width; j++) {
+                    row[j] = glyph_code(board, game, i, j);
+                    frame_glyph(row[j]);
+                }
+                frame_printf("\033[K");
             }
         }
+    }
+    
+    /* Back below the board, dropping the last turn's messages and prompt */
+    frame_printf("\033[%d;1H\033[J", BOARD_LINE + board->height + 1);
+}
+
+/* Fallback when the frame buffer cannot be allocated */
+static void render_plain(const Board *board, const GameState *game) {
+    printf("\033[2J\033[H");
+    printf("=== ZIP PUZZLE ===\n");
+    printf("Next number to reach: %d / %d\n",
+           game->player.next_number, board->max_number);
+    printf(HELP_TEXT "\n\n");
+    
+    char text[GLYPH_MAX];
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            glyph_text(glyph_code(board, game, i, j), text);
+            printf("%s", text);
+        }
         printf("\n");
     }
     printf("\n");
 }
 
+void board_render(const Board *board, const GameState *game) {
+    if (!frame_reserve(board)) {
+        frame.board = NULL;
+        render_plain(board, game);
+        return;
+    }
+    
+    if (frame.board) {
+        render_changes(board, game);
+    } else {
+        render_full(board, game);
+        frame.board = board;
+        frame.height = board->height;
+        frame.width = board->width;
+    }
+    frame.next_number = game->player.next_number;
+}
+
+void ui_release(void) {
+    frame_flush();
+    free(frame.glyphs);
+    free(frame.buffer);
+    memset(&frame, 0, sizeof(frame));
+}
+
 void ui_show_invalid_move(void) {
-    printf("Invalid move! Try again.\n");
+    frame_message("Invalid move! Try again.\n");
 }
 
 void ui_show_undo_failed(void) {
-    printf("Nothing to undo!\n");
+    frame_message("Nothing to undo!\n");
+}
+
+void ui_show_redo_failed(void) {
+    frame_message("Nothing to redo!\n");
 }
 
 void ui_show_win(void) {
-    printf("*** CONGRATULATIONS! YOU WON! ***\n");
-    printf("Press any key to exit...\n");
+    frame_message("*** CONGRATULATIONS! YOU WON! ***\n"
+                  "Press any key to exit...\n");
+}
+
+/* ============================================================================
+ * INPUT
+ * ============================================================================ */
+
+/* Signals that would end the game with the terminal still raw */
+static const int restore_signals[] = {SIGINT, SIGTERM, SIGHUP};
+
+#define RESTORE_SIGNAL_COUNT \
+    ((int)(sizeof(restore_signals) / sizeof(restore_signals[0])))
+
+typedef struct {
+    volatile sig_atomic_t raw;  /* terminal settings below must be restored */
+    bool closed;                /* end of input (or a read error) seen */
+    bool exit_hook;             /* restore_at_exit() registered */
+    struct termios saved;
+    struct sigaction old_actions[RESTORE_SIGNAL_COUNT];
+    unsigned char pending[256]; /* bytes read but not yet decoded */
+    int length;
+} Input;
+
+static Input input;
+
+/* exit() without ui_raw_mode_leave(): put the terminal back anyway */
+static void restore_at_exit(void) {
+    if (input.raw) tcsetattr(STDIN_FILENO, TCSAFLUSH, &input.saved);
+}
+
+/*
+ * A signal that ends the process: restore the terminal, then reinstall
+ * the handler the signal had before raw mode and raise it again, so the
+ * process ends (or not) exactly as it would have. Only async-signal-safe
+ * calls here.
+ */
+static void restore_on_signal(int sig) {
+    if (input.raw) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &input.saved);
+        input.raw = false;
+    }
+    for (int i = 0; i < RESTORE_SIGNAL_COUNT; i++) {
+        if (restore_signals[i] == sig) {
+            sigaction(sig, &input.old_actions[i], NULL);
+        }
+    }
+    raise(sig);
+}
+
+/*
+ * Switch stdin to raw mode: keys arrive unechoed, one byte at a time,
+ * without waiting for Enter. Ctrl-C and Ctrl-D arrive as keys too (and
+ * quit). Output processing stays on, so "\n" still starts a new line.
+ * Returns false, leaving input line-buffered, when stdin is not a
+ * terminal.
+ *
+ * Until ui_raw_mode_leave(), the terminal is also restored if the
+ * process calls exit() or gets SIGINT, SIGTERM or SIGHUP.
+ */
+bool ui_raw_mode_enter(void) {
+    if (input.raw) return true;
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &input.saved) != 0) {
+        return false;
+    }
+    
+    struct termios raw = input.saved;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+    raw.c_iflag &= ~(IXON | ICRNL);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    
+    if (!input.exit_hook) {
+        input.exit_hook = atexit(restore_at_exit) == 0;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = restore_on_signal;
+    sigemptyset(&action.sa_mask);
+    for (int i = 0; i < RESTORE_SIGNAL_COUNT; i++) {
+        sigaction(restore_signals[i], &action, &input.old_actions[i]);
+    }
+    
+    /* Marked raw first, so a signal arriving mid-switch still restores */
+    input.raw = true;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) {
+        input.raw = false;
+        for (int i = 0; i < RESTORE_SIGNAL_COUNT; i++) {
+            sigaction(restore_signals[i], &input.old_actions[i], NULL);
+        }
+        return false;
+    }
+    return true;
+}
+
+void ui_raw_mode_leave(void) {
+    if (!input.raw) return;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &input.saved);
+    input.raw = false;
+    for (int i = 0; i < RESTORE_SIGNAL_COUNT; i++) {
+        sigaction(restore_signals[i], &input.old_actions[i], NULL);
+    }
+}
+
+static bool input_wait(int timeout_ms) {
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    int n;
+    do {
+        n = poll(&fd, 1, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+    return n > 0;
+}
+
+/*
+ * Append every byte already waiting (at most limit in total) to pending.
+ * Returns false when nothing came before the end of input.
+ */
+static bool input_drain(int limit) {
+    int start = input.length;
+    do {
+        ssize_t n = read(STDIN_FILENO, input.pending + input.length,
+                         (size_t)(limit - input.length));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            input.closed = true;
+            break;
+        }
+        input.length += (int)n;
+    } while (input.length < limit && input_wait(0));
+    return input.length > start;
+}
+
+/*
+ * Length of the escape sequence at bytes[0] (an ESC), storing its key
+ * ('w', 'a', 's', 'd' for the arrows, 0 for any other sequence) in
+ * *key; 0 when the sequence is cut off at length
+ */
+static int escape_length(const unsigned char *bytes, int length, char *key) {
+    static const char arrows[] = "wsda";    /* final bytes A, B, C, D */
+    
+    if (length < 2) return 0;
+    if (bytes[1] != '[' && bytes[1] != 'O') {
+        *key = 0;
+        return 1;
+    }
+    
+    /* CSI parameters (e.g. "1;5" for Ctrl+arrow), then a final byte */
+    int i = 2;
+    while (i < length && bytes[i] >= 0x30 && bytes[i] <= 0x3F) i++;
+    if (i == length) return 0;
+    
+    unsigned char final = bytes[i];
+    *key = final >= 'A' && final <= 'D' ? arrows[final - 'A'] : 0;
+    return i + 1;
+}
+
+/*
+ * Decode pending bytes into keys (at most max), keeping an escape
+ * sequence cut off at the end for the next read. Returns the key count.
+ */
+static int input_decode(char *keys, int max, bool flush_escape) {
+    int count = 0;
+    int i = 0;
+    
+    while (i < input.length && count < max) {
+        unsigned char byte = input.pending[i];
+        
+        if (byte == 0x1B) {
+            char key = 0;
+            int length = escape_length(input.pending + i, input.length - i, &key);
+            if (length == 0) {
+                if (!flush_escape) break;
+                length = input.length - i;  /* a lone Esc, or garbage */
+            }
+            if (key) keys[count++] = key;
+            i += length;
+            continue;
+        }
+        
+        i++;
+        if (byte == 0x03 || byte == 0x04) {
+            keys[count++] = 'q';
+        } else if (byte > ' ' && byte < 0x7F) {
+            keys[count++] = (char)byte;
+        }
+    }
+    
+    input.length -= i;
+    memmove(input.pending, input.pending + i, (size_t)input.length);
+    return count;
 }
 
-char ui_get_input(void) {
-    printf("Your move: ");
-    char input[10];
-    if (!fgets(input, sizeof(input), stdin)) {
-        return 'q';
+/*
+ * Prompt, sending the frame board_render() built along with its messages
+ * in the same write, and wait for input. Then return the batch of keys
+ * that has arrived: every byte waiting, decoded (arrows as WASD, Ctrl-C
+ * and Ctrl-D as 'q', whitespace dropped). keys must hold max entries;
+ * anything beyond that stays queued for the next call. At end of input
+ * the batch ends with 'q'.
+ *
+ * Returns:
+ *   Number of keys stored (at least 1)
+ */
+int ui_read_keys(char *keys, int max) {
+    int limit = max < (int)sizeof(input.pending) ? max : (int)sizeof(input.pending);
+    
+    frame_message("Your move: ");
+    frame_flush();
+    
+    for (;;) {
+        int count = input_decode(keys, max, false);
+        if (count > 0) return count;
+        
+        /* An escape cut off at the end that nothing completes is dropped */
+        if (input.length > 0 &&
+            (input.length >= limit || !input_wait(ESCAPE_WAIT_MS))) {
+            input_decode(keys, max, true);
+            continue;
+        }
+        
+        if (input.closed || !input_wait(-1) || !input_drain(limit)) {
+            count = input_decode(keys, max - 1, true);
+            keys[count++] = 'q';
+            return count;
+        }
     }
-    return input[0];
 }